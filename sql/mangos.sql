@@ -24,7 +24,7 @@ CREATE TABLE `db_version` (
   `version` varchar(120) default NULL,
   `creature_ai_version` varchar(120) default NULL,
   `cache_id` int(10) default '0',
-  `required_9160_02_mangos_spell_chain` bit(1) default NULL
+  `required_9178_01_mangos_command` bit(1) default NULL
 ) ENGINE=MyISAM DEFAULT CHARSET=utf8 ROW_FORMAT=FIXED COMMENT='Used DB version notes';
 
 --
@@ -556,6 +556,10 @@ INSERT INTO `command` VALUES
 ('debug setvalue',3,'Syntax: .debug setvalue #field #value #isInt\r\n\r\nSet the field #field of the selected creature with value #value. If no creature is selected, set the content of your field.\r\n\r\nUse a #isInt of value 1 if #value is an integer.'),
 ('debug update',3,'Syntax: .debug update #field #value\r\n\r\nUpdate the field #field of the selected character or creature with value #value.\r\n\r\nIf no #value is provided, display the content of field #field.'),
 ('debug Mod32Value',3,'Syntax: .debug Mod32Value #field #value\r\n\r\nAdd #value to field #field of your character.'),
+('debug los',3,'Syntax: .debug los\r\n\r\nShow hits, misses and hit rate of the vmap line of sight cache since server start.'),
+('debug objectpools',3,'Syntax: .debug objectpools\r\n\r\nShow live objects, allocations and memory of the Spell, Aura and SpellEvent pools.'),
+('debug opcodestats',3,'Syntax: .debug opcodestats [#count] [time|count|in|out|reset]\r\n\r\nShow the #count (default 10) opcodes with the highest handler time, packet count, received or sent bytes since the last reset. Use reset to start a new measurement period.'),
+('debug toptalkers',3,'Syntax: .debug toptalkers [#count]\r\n\r\nShow the #count (default 10) sessions that sent the most packets since the last opcode stats reset.'),
 ('delticket',2,'Syntax: .delticket all\r\n        .delticket #num\r\n        .delticket $character_name\r\n\rall to dalete all tickets at server, $character_name to delete ticket of this character, #num to delete ticket #num.'),
 ('demorph',2,'Syntax: .demorph\r\n\r\nDemorph the selected player.'),
 ('die',3,'Syntax: .die\r\n\r\nKill the selected player. If no player is selected, it will kill you.'),
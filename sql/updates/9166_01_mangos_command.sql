@@ -0,0 +1,7 @@
+ALTER TABLE db_version CHANGE COLUMN required_9160_02_mangos_spell_chain required_9166_01_mangos_command bit;
+
+DELETE FROM command where name IN ('debug opcodestats','debug toptalkers');
+
+INSERT INTO `command` VALUES
+('debug opcodestats',3,'Syntax: .debug opcodestats [#count] [time|count|in|out|reset]\r\n\r\nShow the #count (default 10) opcodes with the highest handler time, packet count, received or sent bytes since the last reset. Use reset to start a new measurement period.'),
+('debug toptalkers',3,'Syntax: .debug toptalkers [#count]\r\n\r\nShow the #count (default 10) sessions that sent the most packets since the last opcode stats reset.');
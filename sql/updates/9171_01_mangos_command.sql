@@ -0,0 +1,6 @@
+ALTER TABLE db_version CHANGE COLUMN required_9166_01_mangos_command required_9171_01_mangos_command bit;
+
+DELETE FROM command where name IN ('debug objectpools');
+
+INSERT INTO `command` VALUES
+('debug objectpools',3,'Syntax: .debug objectpools\r\n\r\nShow live objects, allocations and memory of the Spell, Aura and SpellEvent pools.');
@@ -0,0 +1,6 @@
+ALTER TABLE db_version CHANGE COLUMN required_9171_01_mangos_command required_9178_01_mangos_command bit;
+
+DELETE FROM command where name IN ('debug los');
+
+INSERT INTO `command` VALUES
+('debug los',3,'Syntax: .debug los\r\n\r\nShow hits, misses and hit rate of the vmap line of sight cache since server start.');
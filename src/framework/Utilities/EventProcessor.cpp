@@ -18,15 +18,50 @@
 
 #include "EventProcessor.h"
 
+#include <algorithm>
+#include <cstring>
+
+#define EVENT_TICK_BITS     4                               // 16 ms per wheel tick
+#define EVENT_WHEEL_BITS    5
+#define EVENT_WHEEL_SIZE    (1 << EVENT_WHEEL_BITS)
+#define EVENT_WHEEL_MASK    (EVENT_WHEEL_SIZE - 1)
+#define EVENT_WHEEL_LEVELS  3
+
+struct EventWheel
+{
+    EventWheel() : overflow(NULL), dueNext(0), count(0), seq(0), updating(false)
+    {
+        memset(slots, 0, sizeof(slots));
+    }
+
+    BasicEvent* slots[EVENT_WHEEL_LEVELS][EVENT_WHEEL_SIZE];
+    BasicEvent* overflow;                                   // events beyond the last level
+    std::vector<BasicEvent*> due;                           // events executed by the current Update, sorted
+    size_t dueNext;                                         // first event in due not executed yet
+    uint32 count;                                           // events in slots and overflow
+    uint32 seq;
+    bool updating;
+};
+
+static bool EventExecOrder(BasicEvent const* a, BasicEvent const* b)
+{
+    if (a->m_execTime != b->m_execTime)
+        return a->m_execTime < b->m_execTime;
+    return a->m_eventSeq < b->m_eventSeq;
+}
+
 EventProcessor::EventProcessor()
 {
     m_time = 0;
+    m_tick = 0;
+    m_wheel = NULL;
     m_aborting = false;
 }
 
 EventProcessor::~EventProcessor()
 {
     KillAllEvents(true);
+    delete m_wheel;
 }
 
 void EventProcessor::Update(uint32 p_time)
@@ -34,13 +69,30 @@ void EventProcessor::Update(uint32 p_time)
     // update time
     m_time += p_time;
 
+    // nothing queued, no need to walk the empty slots
+    if (!m_wheel || !m_wheel->count)
+    {
+        m_tick = m_time >> EVENT_TICK_BITS;
+        return;
+    }
+
+    // move all events with m_execTime <= m_time to the due list
+    Collect(m_time >> EVENT_TICK_BITS);
+
+    // events added with a past time during execution are inserted in order and run in this loop too
+    std::sort(m_wheel->due.begin(), m_wheel->due.end(), EventExecOrder);
+    m_wheel->dueNext = 0;
+    m_wheel->updating = true;
+
     // main event loop
-    EventList::iterator i;
-    while (((i = m_events.begin()) != m_events.end()) && i->first <= m_time)
+    while (m_wheel->dueNext < m_wheel->due.size())
     {
         // get and remove event from queue
-        BasicEvent* Event = i->second;
-        m_events.erase(i);
+        size_t i = m_wheel->dueNext++;
+        BasicEvent* Event = m_wheel->due[i];
+        if (!Event)                                         // deleted by KillAllEvents
+            continue;
+        m_wheel->due[i] = NULL;
 
         if (!Event->to_Abort)
         {
@@ -56,6 +108,119 @@ void EventProcessor::Update(uint32 p_time)
             delete Event;
         }
     }
+
+    m_wheel->due.clear();
+    m_wheel->dueNext = 0;
+    m_wheel->updating = false;
+}
+
+void EventProcessor::Collect(uint64 newTick)
+{
+    // after a long pause it is cheaper to re-sort everything than to walk each tick
+    if (newTick - m_tick >= EVENT_WHEEL_SIZE * EVENT_WHEEL_SIZE)
+    {
+        BasicEvent* all = NULL;
+        for (int level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+        {
+            for (int slot = 0; slot < EVENT_WHEEL_SIZE; ++slot)
+            {
+                while (BasicEvent* Event = m_wheel->slots[level][slot])
+                {
+                    m_wheel->slots[level][slot] = Event->m_nextEvent;
+                    Event->m_nextEvent = all;
+                    all = Event;
+                }
+            }
+        }
+        while (BasicEvent* Event = m_wheel->overflow)
+        {
+            m_wheel->overflow = Event->m_nextEvent;
+            Event->m_nextEvent = all;
+            all = Event;
+        }
+
+        m_tick = newTick;
+        Reschedule(all);
+        return;
+    }
+
+    for (;;)
+    {
+        // the current slot is processed again on each update, it also holds events added for the current tick
+        BasicEvent*& slot = m_wheel->slots[0][m_tick & EVENT_WHEEL_MASK];
+        BasicEvent* list = slot;
+        slot = NULL;
+        Reschedule(list);
+
+        if (m_tick == newTick)
+            break;
+
+        ++m_tick;
+        if (!(m_tick & EVENT_WHEEL_MASK))
+            Cascade();
+    }
+}
+
+void EventProcessor::Cascade()
+{
+    for (int level = 1; level < EVENT_WHEEL_LEVELS; ++level)
+    {
+        uint32 index = uint32(m_tick >> (EVENT_WHEEL_BITS * level)) & EVENT_WHEEL_MASK;
+
+        BasicEvent* list = m_wheel->slots[level][index];
+        m_wheel->slots[level][index] = NULL;
+        Reschedule(list);
+
+        // higher levels only move when this one wrapped
+        if (index)
+            return;
+    }
+
+    BasicEvent* list = m_wheel->overflow;
+    m_wheel->overflow = NULL;
+    Reschedule(list);
+}
+
+void EventProcessor::Reschedule(BasicEvent* list)
+{
+    while (BasicEvent* Event = list)
+    {
+        list = Event->m_nextEvent;
+        --m_wheel->count;
+
+        if (Event->m_execTime <= m_time)
+        {
+            Event->m_nextEvent = NULL;
+            m_wheel->due.push_back(Event);
+        }
+        else
+            Schedule(Event);
+    }
+}
+
+void EventProcessor::Schedule(BasicEvent* Event)
+{
+    uint64 e_tick = Event->m_execTime >> EVENT_TICK_BITS;
+
+    BasicEvent** slot = &m_wheel->overflow;
+    if (e_tick <= m_tick)
+        slot = &m_wheel->slots[0][m_tick & EVENT_WHEEL_MASK];
+    else
+    {
+        uint64 diff = e_tick - m_tick;
+        for (int level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+        {
+            if (diff < (uint64(1) << (EVENT_WHEEL_BITS * (level + 1))))
+            {
+                slot = &m_wheel->slots[level][uint32(e_tick >> (EVENT_WHEEL_BITS * level)) & EVENT_WHEEL_MASK];
+                break;
+            }
+        }
+    }
+
+    Event->m_nextEvent = *slot;
+    *slot = Event;
+    ++m_wheel->count;
 }
 
 void EventProcessor::KillAllEvents(bool force)
@@ -63,33 +228,77 @@ void EventProcessor::KillAllEvents(bool force)
     // prevent event insertions
     m_aborting = true;
 
-    // first, abort all existing events
-    for (EventList::iterator i = m_events.begin(); i != m_events.end();)
+    if (!m_wheel)
+        return;
+
+    // first, abort events already due in a running Update
+    for (size_t i = 0; i < m_wheel->due.size(); ++i)
     {
-        EventList::iterator i_old = i;
-        ++i;
+        BasicEvent* Event = m_wheel->due[i];
+        if (!Event)
+            continue;
 
-        i_old->second->to_Abort = true;
-        i_old->second->Abort(m_time);
-        if(force || i_old->second->IsDeletable())
+        Event->to_Abort = true;
+        Event->Abort(m_time);
+        if (force || Event->IsDeletable())
         {
-            delete i_old->second;
-
-            if(!force)                                      // need per-element cleanup
-                m_events.erase (i_old);
+            delete Event;
+            m_wheel->due[i] = NULL;
         }
     }
 
-    // fast clear event list (in force case)
-    if(force)
-        m_events.clear();
+    // then all queued ones
+    for (int level = 0; level < EVENT_WHEEL_LEVELS; ++level)
+        for (int slot = 0; slot < EVENT_WHEEL_SIZE; ++slot)
+            AbortList(m_wheel->slots[level][slot], force);
+    AbortList(m_wheel->overflow, force);
+}
+
+void EventProcessor::AbortList(BasicEvent*& list, bool force)
+{
+    BasicEvent** link = &list;
+    while (BasicEvent* Event = *link)
+    {
+        Event->to_Abort = true;
+        Event->Abort(m_time);
+        if (force || Event->IsDeletable())
+        {
+            *link = Event->m_nextEvent;
+            --m_wheel->count;
+            delete Event;
+        }
+        else                                                // stays queued, gets Abort call again when due
+            link = &Event->m_nextEvent;
+    }
 }
 
 void EventProcessor::AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime)
 {
     if (set_addtime) Event->m_addTime = m_time;
     Event->m_execTime = e_time;
-    m_events.insert(std::pair<uint64, BasicEvent*>(e_time, Event));
+
+    if (!m_wheel)
+    {
+        m_wheel = new EventWheel;
+        m_tick = m_time >> EVENT_TICK_BITS;
+    }
+
+    Event->m_eventSeq = m_wheel->seq++;
+
+    // already due events added by a running Update are executed by it, as before
+    if (m_wheel->updating && e_time <= m_time)
+    {
+        Event->m_nextEvent = NULL;
+
+        // keep the not executed part sorted, slots emptied by KillAllEvents are skipped
+        std::vector<BasicEvent*>& due = m_wheel->due;
+        size_t pos = due.size();
+        while (pos > m_wheel->dueNext && (!due[pos - 1] || EventExecOrder(Event, due[pos - 1])))
+            --pos;
+        due.insert(due.begin() + pos, Event);
+    }
+    else
+        Schedule(Event);
 }
 
 uint64 EventProcessor::CalculateTime(uint64 t_offset)
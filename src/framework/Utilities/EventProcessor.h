@@ -21,14 +21,14 @@
 
 #include "Platform/Define.h"
 
-#include<map>
+#include<vector>
 
 // Note. All times are in milliseconds here.
 
 class BasicEvent
 {
     public:
-        BasicEvent() { to_Abort = false; }
+        BasicEvent() : m_nextEvent(NULL), m_eventSeq(0) { to_Abort = false; }
         virtual ~BasicEvent()                               // override destructor to perform some actions on event removal
         {
         };
@@ -48,10 +48,22 @@ class BasicEvent
         // these can be used for time offset control
         uint64 m_addTime;                                   // time when the event was added to queue, filled by event handler
         uint64 m_execTime;                                  // planned time of next execution, filled by event handler
+
+        // used by EventProcessor only
+        BasicEvent* m_nextEvent;                            // next event in the same wheel slot
+        uint32 m_eventSeq;                                  // add order, keeps events with equal m_execTime in order
 };
 
-typedef std::multimap<uint64, BasicEvent*> EventList;
+struct EventWheel;
 
+/**
+ * Events are kept in a hierarchical timing wheel (16 ms ticks, 3 levels of
+ * 32 slots, an overflow list beyond ~8.7 min), linked through the events
+ * themselves: AddEvent and expiry are O(1). The wheel is allocated at the
+ * first AddEvent and kept until destruction, units that never get events
+ * pay for a pointer only.
+ * Events due in the same Update still execute in (m_execTime, add order).
+ */
 class EventProcessor
 {
     public:
@@ -63,8 +75,15 @@ class EventProcessor
         void AddEvent(BasicEvent* Event, uint64 e_time, bool set_addtime = true);
         uint64 CalculateTime(uint64 t_offset);
     protected:
+        void Schedule(BasicEvent* Event);
+        void Reschedule(BasicEvent* list);
+        void Cascade();
+        void Collect(uint64 newTick);
+        void AbortList(BasicEvent*& list, bool force);
+
         uint64 m_time;
-        EventList m_events;
+        uint64 m_tick;                                      // wheel position, all slots before it are processed
+        EventWheel* m_wheel;
         bool m_aborting;
 };
 #endif
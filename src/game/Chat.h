@@ -133,14 +133,18 @@ class ChatHandler
         bool HandleDebugBattlegroundCommand(const char * args);
         bool HandleDebugGetItemStateCommand(const char * args);
         bool HandleDebugGetLootRecipientCommand(const char * args);
+        bool HandleDebugLineOfSightCommand(const char* args);
         bool HandleDebugGetValueCommand(const char* args);
         bool HandleDebugGetItemValueCommand(const char* args);
         bool HandleDebugMod32ValueCommand(const char* args);
+        bool HandleDebugObjectPoolsCommand(const char* args);
+        bool HandleDebugOpcodeStatsCommand(const char* args);
         bool HandleDebugSetAuraStateCommand(const char * args);
         bool HandleDebugSetItemValueCommand(const char * args);
         bool HandleDebugSetValueCommand(const char* args);
         bool HandleDebugSpawnVehicle(const char * args);
         bool HandleDebugSpellCheckCommand(const char* args);
+        bool HandleDebugTopTalkersCommand(const char* args);
         bool HandleDebugUpdateCommand(const char* args);
         bool HandleDebugUpdateWorldStateCommand(const char* args);
 
@@ -359,6 +359,9 @@ typedef std::map<uint32,time_t> CreatureSpellCooldowns;
 // max different by z coordinate for creature aggro reaction
 #define CREATURE_Z_ATTACK_RANGE 3
 
+// distance a moving creature may go between two relocation notifier calls (aggro and visibility checks)
+#define CREATURE_RELOCATION_NOTIFY_DIST 4.0f
+
 #define MAX_VENDOR_ITEMS 150                                // Limitation in 3.x.x item count in SMSG_LIST_INVENTORY
 
 class MANGOS_DLL_SPEC Creature : public Unit
@@ -533,6 +536,15 @@ class MANGOS_DLL_SPEC Creature : public Unit
         Cell const& GetCurrentCell() const { return m_currentCell; }
         void SetCurrentCell(Cell const& cell) { m_currentCell = cell; }
 
+        // position at the last relocation notifier call
+        void SetRelocationNotifyPos(float x, float y) { m_relocationNotifyX = x; m_relocationNotifyY = y; }
+        bool IsNearRelocationNotifyPos(float x, float y) const
+        {
+            float dx = x - m_relocationNotifyX;
+            float dy = y - m_relocationNotifyY;
+            return dx*dx + dy*dy < CREATURE_RELOCATION_NOTIFY_DIST*CREATURE_RELOCATION_NOTIFY_DIST;
+        }
+
         bool IsVisibleInGridForPlayer(Player* pl) const;
 
         void RemoveCorpse();
@@ -617,6 +629,8 @@ class MANGOS_DLL_SPEC Creature : public Unit
         void RegenerateHealth();
         MovementGeneratorType m_defaultMovementType;
         Cell m_currentCell;                                 // store current cell where creature listed
+        float m_relocationNotifyX;
+        float m_relocationNotifyY;
         uint32 m_DBTableGuid;                               ///< For new or temporary creatures is 0 for saved it is lowguid
         uint32 m_equipmentId;
 
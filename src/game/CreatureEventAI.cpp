@@ -58,6 +58,8 @@ CreatureEventAI::CreatureEventAI(Creature *c ) : CreatureAI(c)
     CreatureEventAI_Event_Map::const_iterator CreatureEvents = sEventAIMgr.GetCreatureEventAIMap().find(m_creature->GetEntry());
     if (CreatureEvents != sEventAIMgr.GetCreatureEventAIMap().end())
     {
+        CreatureEventAIList.reserve((*CreatureEvents).second.size());
+
         std::vector<CreatureEventAI_Event>::const_iterator i;
         for (i = (*CreatureEvents).second.begin(); i != (*CreatureEvents).second.end(); ++i)
         {
@@ -85,6 +87,8 @@ CreatureEventAI::CreatureEventAI(Creature *c ) : CreatureAI(c)
     else
         sLog.outError("CreatureEventAI: EventMap for Creature %u is empty but creature is using CreatureEventAI.", m_creature->GetEntry());
 
+    BuildEventTypeIndex();
+
     bEmptyList = CreatureEventAIList.empty();
     Phase = 0;
     CombatMovementEnabled = true;
@@ -97,13 +101,39 @@ CreatureEventAI::CreatureEventAI(Creature *c ) : CreatureAI(c)
     //Handle Spawned Events
     if (!bEmptyList)
     {
-        for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-            if (SpawnedEventConditionsCheck((*i).Event))
-                ProcessEvent(*i);
+        for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_SPAWNED); i != EventsEnd(EVENT_T_SPAWNED); ++i)
+            if (SpawnedEventConditionsCheck((*i)->Event))
+                ProcessEvent(**i);
     }
     Reset();
 }
 
+void CreatureEventAI::BuildEventTypeIndex()
+{
+    // count events of each type, then place pointers by type keeping list order
+    uint16 count[EVENT_T_END];
+    memset(count, 0, sizeof(count));
+
+    for (CreatureEventAIHolderList::const_iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+        if ((*i).Event.event_type < EVENT_T_END)
+            ++count[(*i).Event.event_type];
+
+    m_eventTypeStart[0] = 0;
+    for (int type = 0; type < EVENT_T_END; ++type)
+        m_eventTypeStart[type+1] = m_eventTypeStart[type] + count[type];
+
+    // one extra element, EventsBegin/EventsEnd need valid &m_eventsByType[0]
+    m_eventsByType.resize(m_eventTypeStart[EVENT_T_END] + 1, NULL);
+
+    memset(count, 0, sizeof(count));
+    for (CreatureEventAIHolderList::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+    {
+        uint32 type = (*i).Event.event_type;
+        if (type < EVENT_T_END)
+            m_eventsByType[m_eventTypeStart[type] + count[type]++] = &*i;
+    }
+}
+
 bool CreatureEventAI::ProcessEvent(CreatureEventAIHolder& pHolder, Unit* pActionInvoker)
 {
     if (!pHolder.Enabled || pHolder.Time)
@@ -793,9 +823,9 @@ void CreatureEventAI::JustRespawned()
         return;
 
     //Handle Spawned Events
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-        if (SpawnedEventConditionsCheck((*i).Event))
-            ProcessEvent(*i);
+    for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_SPAWNED); i != EventsEnd(EVENT_T_SPAWNED); ++i)
+        if (SpawnedEventConditionsCheck((*i)->Event))
+            ProcessEvent(**i);
 }
 
 void CreatureEventAI::Reset()
@@ -806,25 +836,12 @@ void CreatureEventAI::Reset()
     if (bEmptyList)
         return;
 
-    //Reset all events to enabled
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+    //Reset all out of combat timers, other events (ex. aggro yell) are enabled again in EnterCombat
+    for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_TIMER_OOC); i != EventsEnd(EVENT_T_TIMER_OOC); ++i)
     {
-        CreatureEventAI_Event const& event = (*i).Event;
-        switch (event.event_type)
-        {
-            //Reset all out of combat timers
-            case EVENT_T_TIMER_OOC:
-            {
-                if ((*i).UpdateRepeatTimer(m_creature,event.timer.initialMin,event.timer.initialMax))
-                    (*i).Enabled = true;
-                break;
-            }
-            //default:
-            //TODO: enable below code line / verify this is correct to enable events previously disabled (ex. aggro yell), instead of enable this in void Aggro()
-            //(*i).Enabled = true;
-            //(*i).Time = 0;
-            //break;
-        }
+        CreatureEventAI_Event const& event = (*i)->Event;
+        if ((*i)->UpdateRepeatTimer(m_creature,event.timer.initialMin,event.timer.initialMax))
+            (*i)->Enabled = true;
     }
 }
 
@@ -834,11 +851,8 @@ void CreatureEventAI::JustReachedHome()
 
     if (!bEmptyList)
     {
-        for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-        {
-            if ((*i).Event.event_type == EVENT_T_REACHED_HOME)
-                ProcessEvent(*i);
-        }
+        for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_REACHED_HOME); i != EventsEnd(EVENT_T_REACHED_HOME); ++i)
+            ProcessEvent(**i);
     }
 
     Reset();
@@ -859,11 +873,8 @@ void CreatureEventAI::EnterEvadeMode()
         return;
 
     //Handle Evade events
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_EVADE)
-            ProcessEvent(*i);
-    }
+    for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_EVADE); i != EventsEnd(EVENT_T_EVADE); ++i)
+        ProcessEvent(**i);
 }
 
 void CreatureEventAI::JustDied(Unit* killer)
@@ -874,11 +885,8 @@ void CreatureEventAI::JustDied(Unit* killer)
         return;
 
     //Handle Evade events
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_DEATH)
-            ProcessEvent(*i, killer);
-    }
+    for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_DEATH); i != EventsEnd(EVENT_T_DEATH); ++i)
+        ProcessEvent(**i, killer);
 
     // reset phase after any death state events
     Phase = 0;
@@ -889,11 +897,8 @@ void CreatureEventAI::KilledUnit(Unit* victim)
     if (bEmptyList || victim->GetTypeId() != TYPEID_PLAYER)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_KILL)
-            ProcessEvent(*i, victim);
-    }
+    for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_KILL); i != EventsEnd(EVENT_T_KILL); ++i)
+        ProcessEvent(**i, victim);
 }
 
 void CreatureEventAI::JustSummoned(Creature* pUnit)
@@ -901,11 +906,8 @@ void CreatureEventAI::JustSummoned(Creature* pUnit)
     if (bEmptyList || !pUnit)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-    {
-        if ((*i).Event.event_type == EVENT_T_SUMMONED_UNIT)
-            ProcessEvent(*i, pUnit);
-    }
+    for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_SUMMONED_UNIT); i != EventsEnd(EVENT_T_SUMMONED_UNIT); ++i)
+        ProcessEvent(**i, pUnit);
 }
 
 void CreatureEventAI::EnterCombat(Unit *enemy)
@@ -913,7 +915,7 @@ void CreatureEventAI::EnterCombat(Unit *enemy)
     //Check for on combat start events
     if (!bEmptyList)
     {
-        for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+        for (CreatureEventAIHolderList::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
         {
             CreatureEventAI_Event const& event = (*i).Event;
             switch (event.event_type)
@@ -971,21 +973,18 @@ void CreatureEventAI::MoveInLineOfSight(Unit *who)
     //Check for OOC LOS Event
     if (!bEmptyList && !m_creature->getVictim())
     {
-        for (std::list<CreatureEventAIHolder>::iterator itr = CreatureEventAIList.begin(); itr != CreatureEventAIList.end(); ++itr)
+        for (CreatureEventAIHolder** itr = EventsBegin(EVENT_T_OOC_LOS); itr != EventsEnd(EVENT_T_OOC_LOS); ++itr)
         {
-            if ((*itr).Event.event_type == EVENT_T_OOC_LOS)
-            {
-                //can trigger if closer than fMaxAllowedRange
-                float fMaxAllowedRange = (*itr).Event.ooc_los.maxRange;
+            //can trigger if closer than fMaxAllowedRange
+            float fMaxAllowedRange = (*itr)->Event.ooc_los.maxRange;
 
-                //if range is ok and we are actually in LOS
-                if (m_creature->IsWithinDistInMap(who, fMaxAllowedRange) && m_creature->IsWithinLOSInMap(who))
-                {
-                    //if friendly event&&who is not hostile OR hostile event&&who is hostile
-                    if (((*itr).Event.ooc_los.noHostile && !m_creature->IsHostileTo(who)) ||
-                        ((!(*itr).Event.ooc_los.noHostile) && m_creature->IsHostileTo(who)))
-                        ProcessEvent(*itr, who);
-                }
+            //if range is ok and we are actually in LOS
+            if (m_creature->IsWithinDistInMap(who, fMaxAllowedRange) && m_creature->IsWithinLOSInMap(who))
+            {
+                //if friendly event&&who is not hostile OR hostile event&&who is hostile
+                if (((*itr)->Event.ooc_los.noHostile && !m_creature->IsHostileTo(who)) ||
+                    ((!(*itr)->Event.ooc_los.noHostile) && m_creature->IsHostileTo(who)))
+                    ProcessEvent(**itr, who);
             }
         }
     }
@@ -1022,12 +1021,11 @@ void CreatureEventAI::SpellHit(Unit* pUnit, const SpellEntry* pSpell)
     if (bEmptyList)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
-        if ((*i).Event.event_type == EVENT_T_SPELLHIT)
-            //If spell id matches (or no spell id) & if spell school matches (or no spell school)
-            if (!(*i).Event.spell_hit.spellId || pSpell->Id == (*i).Event.spell_hit.spellId)
-                if (pSpell->SchoolMask & (*i).Event.spell_hit.schoolMask)
-                    ProcessEvent(*i, pUnit);
+    for (CreatureEventAIHolder** i = EventsBegin(EVENT_T_SPELLHIT); i != EventsEnd(EVENT_T_SPELLHIT); ++i)
+        //If spell id matches (or no spell id) & if spell school matches (or no spell school)
+        if (!(*i)->Event.spell_hit.spellId || pSpell->Id == (*i)->Event.spell_hit.spellId)
+            if (pSpell->SchoolMask & (*i)->Event.spell_hit.schoolMask)
+                ProcessEvent(**i, pUnit);
 }
 
 void CreatureEventAI::UpdateAI(const uint32 diff)
@@ -1047,7 +1045,7 @@ void CreatureEventAI::UpdateAI(const uint32 diff)
             EventDiff += diff;
 
             //Check for time based events
-            for (std::list<CreatureEventAIHolder>::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
+            for (CreatureEventAIHolderList::iterator i = CreatureEventAIList.begin(); i != CreatureEventAIList.end(); ++i)
             {
                 //Decrement Timers
                 if ((*i).Time)
@@ -1368,19 +1366,16 @@ void CreatureEventAI::ReceiveEmote(Player* pPlayer, uint32 text_emote)
     if (bEmptyList)
         return;
 
-    for (std::list<CreatureEventAIHolder>::iterator itr = CreatureEventAIList.begin(); itr != CreatureEventAIList.end(); ++itr)
+    for (CreatureEventAIHolder** itr = EventsBegin(EVENT_T_RECEIVE_EMOTE); itr != EventsEnd(EVENT_T_RECEIVE_EMOTE); ++itr)
     {
-        if ((*itr).Event.event_type == EVENT_T_RECEIVE_EMOTE)
-        {
-            if ((*itr).Event.receive_emote.emoteId != text_emote)
-                return;
+        if ((*itr)->Event.receive_emote.emoteId != text_emote)
+            return;
 
-            PlayerCondition pcon((*itr).Event.receive_emote.condition,(*itr).Event.receive_emote.conditionValue1,(*itr).Event.receive_emote.conditionValue2);
-            if (pcon.Meets(pPlayer))
-            {
-                sLog.outDebug("CreatureEventAI: ReceiveEmote CreatureEventAI: Condition ok, processing");
-                ProcessEvent(*itr, pPlayer);
-            }
+        PlayerCondition pcon((*itr)->Event.receive_emote.condition,(*itr)->Event.receive_emote.conditionValue1,(*itr)->Event.receive_emote.conditionValue2);
+        if (pcon.Meets(pPlayer))
+        {
+            sLog.outDebug("CreatureEventAI: ReceiveEmote CreatureEventAI: Condition ok, processing");
+            ProcessEvent(**itr, pPlayer);
         }
     }
 }
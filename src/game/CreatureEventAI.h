@@ -558,6 +558,9 @@ struct CreatureEventAIHolder
     bool UpdateRepeatTimer(Creature* creature, uint32 repeatMin, uint32 repeatMax);
 };
 
+typedef std::vector<CreatureEventAIHolder> CreatureEventAIHolderList;
+typedef std::vector<CreatureEventAIHolder*> CreatureEventAIHolderPtrList;
+
 class MANGOS_DLL_SPEC CreatureEventAI : public CreatureAI
 {
 
@@ -597,12 +600,20 @@ class MANGOS_DLL_SPEC CreatureEventAI : public CreatureAI
 
         bool SpawnedEventConditionsCheck(CreatureEventAI_Event const& event);
 
+        void BuildEventTypeIndex();
+        CreatureEventAIHolder** EventsBegin(EventAI_Type type) { return &m_eventsByType[0] + m_eventTypeStart[type]; }
+        CreatureEventAIHolder** EventsEnd(EventAI_Type type) { return &m_eventsByType[0] + m_eventTypeStart[type+1]; }
+
         Unit* DoSelectLowestHpFriendly(float range, uint32 MinHPDiff);
         void DoFindFriendlyMissingBuff(std::list<Creature*>& _list, float range, uint32 spellid);
         void DoFindFriendlyCC(std::list<Creature*>& _list, float range);
 
                                                             //Holder for events (stores enabled, time, and eventid)
-        std::list<CreatureEventAIHolder> CreatureEventAIList;
+        CreatureEventAIHolderList CreatureEventAIList;      // not changed after constructor, pointers to elements are stable
+                                                            // Events grouped by type (list order inside type), events of type T are
+                                                            // m_eventsByType[m_eventTypeStart[T]] .. m_eventsByType[m_eventTypeStart[T+1]-1]
+        CreatureEventAIHolderPtrList m_eventsByType;
+        uint16 m_eventTypeStart[EVENT_T_END+1];
         uint32 EventUpdateTime;                             //Time between event updates
         uint32 EventDiff;                                   //Time between the last event call
         bool bEmptyList;
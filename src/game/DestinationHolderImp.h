@@ -109,7 +109,8 @@ DestinationHolder<TRAVELLER>::UpdateTraveller(TRAVELLER &traveller, uint32 diff,
             if (traveller.GetTraveller().GetPositionX() != x || traveller.GetTraveller().GetPositionY() != y  || traveller.GetTraveller().GetPositionZ() != z)
             {
                 float ori = traveller.GetTraveller().GetAngle(x, y);
-                traveller.Relocation(x, y, z, ori);
+                // nearby units are told at the end of the move or after some distance, not each update
+                traveller.Relocation(x, y, z, ori, !HasArrived());
             }
             return true;
         }
@@ -134,7 +135,7 @@ DestinationHolder<TRAVELLER>::UpdateTraveller(TRAVELLER &traveller, uint32 diff,
         if (traveller.GetTraveller().GetPositionX() != x || traveller.GetTraveller().GetPositionY() != y || traveller.GetTraveller().GetPositionZ() != z)
         {
             float ori = traveller.GetTraveller().GetAngle(x, y);
-            traveller.Relocation(x, y, z, ori);
+            traveller.Relocation(x, y, z, ori, !HasArrived());
         }
         // Change movement computation to micro movement based on last tick coords, this makes system work
         // even on multiple floors zones without hugh vmaps usage ;)
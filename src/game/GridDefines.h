@@ -40,6 +40,7 @@ class Player;
 #define CENTER_GRID_OFFSET      (SIZE_OF_GRIDS/2)
 
 #define MIN_GRID_DELAY          (MINUTE*IN_MILISECONDS)
+#define MAX_GRID_UNLOAD_FACTOR  8                           // max multiplier of the grid unload delay for often reloaded grids
 #define MIN_MAP_UPDATE_DELAY    50
 
 #define MAX_NUMBER_OF_CELLS     8
@@ -123,8 +123,8 @@ VisibleNotifier::Notify()
         i_player.GetSession()->SendPacket(&packet);
 
         // send out of range to other players if need
-        std::set<uint64> const& oor = i_data.GetOutOfRangeGUIDs();
-        for(std::set<uint64>::const_iterator iter = oor.begin(); iter != oor.end(); ++iter)
+        UpdateData::GuidList const& oor = i_data.GetOutOfRangeGUIDs();
+        for(UpdateData::GuidList::const_iterator iter = oor.begin(); iter != oor.end(); ++iter)
         {
             if(!IS_PLAYER_GUID(*iter))
                 continue;
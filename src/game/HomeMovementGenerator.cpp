@@ -50,6 +50,14 @@ HomeMovementGenerator<Creature>::_setTargetLocation(Creature & owner)
 
     CreatureTraveller traveller(owner);
 
+    i_pathIndex = 0;
+    if (owner.GetMap()->GetPathFinder().Calculate(owner, x, y, z, i_path))
+    {
+        x = i_path[0].x;
+        y = i_path[0].y;
+        z = i_path[0].z;
+    }
+
     uint32 travel_time = i_destinationHolder.SetDestination(traveller, x, y, z);
     modifyTravelTime(travel_time);
     owner.clearUnitState(UNIT_STAT_ALL_STATE);
@@ -63,6 +71,15 @@ HomeMovementGenerator<Creature>::Update(Creature &owner, const uint32& time_diff
 
     if (time_diff > i_travel_timer)
     {
+        // reached a corner of the path, go on to the next one
+        if (i_pathIndex + 1 < i_path.size())
+        {
+            i_destinationHolder.UpdateTraveller(traveller, 0, true);
+            ++i_pathIndex;
+            modifyTravelTime(i_destinationHolder.SetDestination(traveller, i_path[i_pathIndex].x, i_path[i_pathIndex].y, i_path[i_pathIndex].z));
+            return true;
+        }
+
         owner.AddMonsterMoveFlag(MONSTER_MOVE_WALK);
 
         // restore orientation of not moving creature at returning to home
@@ -22,6 +22,7 @@
 #include "MovementGenerator.h"
 #include "DestinationHolder.h"
 #include "Traveller.h"
+#include "PathFinder.h"
 
 class Creature;
 
@@ -34,7 +35,7 @@ class MANGOS_DLL_SPEC HomeMovementGenerator<Creature>
 {
     public:
 
-        HomeMovementGenerator() {}
+        HomeMovementGenerator() : i_pathIndex(0) {}
         ~HomeMovementGenerator() {}
 
         void Initialize(Creature &);
@@ -50,5 +51,9 @@ class MANGOS_DLL_SPEC HomeMovementGenerator<Creature>
         DestinationHolder< Traveller<Creature> > i_destinationHolder;
 
         uint32 i_travel_timer;
+
+        // corners around unwalkable terrain, empty when going straight home
+        PointPath i_path;
+        uint32 i_pathIndex;
 };
 #endif
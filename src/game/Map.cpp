@@ -143,9 +143,8 @@ void Map::LoadMap(int gx,int gy, bool reload)
         if(GridMaps[gx][gy])
             return;
 
-        // load grid map for base map
-        if (!m_parentMap->GridMaps[gx][gy])
-            m_parentMap->EnsureGridCreated(GridPair(63-gx,63-gy));
+        // load grid map for base map, the terrain may be kept there without grid
+        m_parentMap->EnsureGridCreated(GridPair(63-gx,63-gy));
 
         ((MapInstanced*)(m_parentMap))->AddGridMapReference(GridPair(gx,gy));
         GridMaps[gx][gy] = m_parentMap->GridMaps[gx][gy];
@@ -206,7 +205,7 @@ Map::Map(uint32 id, time_t expiry, uint32 InstanceId, uint8 SpawnMode, Map* _par
   i_id(id), i_InstanceId(InstanceId), m_unloadTimer(0),
   m_VisibleDistance(DEFAULT_VISIBILITY_DISTANCE),
   m_activeNonPlayersIter(m_activeNonPlayers.end()),
-  i_gridExpiry(expiry), m_parentMap(_parent ? _parent : this),
+  m_pathFinder(this), i_gridExpiry(expiry), m_parentMap(_parent ? _parent : this), m_cachedGridMapsSize(0),
   m_hiDynObjectGuid(1), m_hiPetGuid(1), m_hiVehicleGuid(1)
 {
     for(unsigned int idx=0; idx < MAX_NUMBER_OF_GRIDS; ++idx)
@@ -364,12 +363,16 @@ Map::EnsureGridCreated(const GridPair &p)
 
             getNGrid(p.x_coord, p.y_coord)->SetGridState(GRID_STATE_IDLE);
 
+            UpdateGridUnloadFactor(getNGrid(p.x_coord, p.y_coord)->GetGridId());
+
             //z coord
             int gx = (MAX_NUMBER_OF_GRIDS - 1) - p.x_coord;
             int gy = (MAX_NUMBER_OF_GRIDS - 1) - p.y_coord;
 
             if(!GridMaps[gx][gy])
                 LoadMapAndVMap(gx,gy);
+            else
+                UncacheGridMap(gx,gy);
         }
     }
 }
@@ -590,6 +593,18 @@ bool Map::loaded(const GridPair &p) const
 
 void Map::Update(const uint32 &t_diff)
 {
+    /// process map-local packets of the players (World::UpdateSessions leaves them to us)
+    for(m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
+    {
+        Player* plr = m_mapRefIter->getSource();
+        if(plr && plr->IsInWorld())
+        {
+            WorldSession* pSession = plr->GetSession();
+            MapSessionFilter updater(pSession);
+            pSession->Update(t_diff, updater);
+        }
+    }
+
     /// update players at tick
     for(m_mapRefIter = m_mapRefManager.begin(); m_mapRefIter != m_mapRefManager.end(); ++m_mapRefIter)
     {
@@ -850,7 +865,7 @@ Map::Remove(T *obj, bool remove)
 }
 
 void
-Map::PlayerRelocation(Player *player, float x, float y, float z, float orientation)
+Map::PlayerRelocation(Player *player, float x, float y, float z, float orientation, bool lazyNotify)
 {
     assert(player);
 
@@ -879,6 +894,9 @@ Map::PlayerRelocation(Player *player, float x, float y, float z, float orientati
         else
             EnsureGridLoadedAtEnter(new_cell, player);
     }
+    // the path is known in advance, what is around is updated at cell changes and path nodes only
+    else if (lazyNotify)
+        return;
 
     // if move then update what player see and who seen
     UpdatePlayerVisibility(player,new_cell,new_val);
@@ -893,7 +911,7 @@ Map::PlayerRelocation(Player *player, float x, float y, float z, float orientati
 }
 
 void
-Map::CreatureRelocation(Creature *creature, float x, float y, float z, float ang)
+Map::CreatureRelocation(Creature *creature, float x, float y, float z, float ang, bool lazyNotify)
 {
     assert(CheckGridIntegrity(creature,false));
 
@@ -915,7 +933,8 @@ Map::CreatureRelocation(Creature *creature, float x, float y, float z, float ang
     else
     {
         creature->Relocate(x, y, z, ang);
-        CreatureRelocationNotify(creature,new_cell,new_val);
+        if (!lazyNotify || !creature->IsNearRelocationNotifyPos(x, y))
+            CreatureRelocationNotify(creature,new_cell,new_val);
     }
     assert(CheckGridIntegrity(creature,true));
 }
@@ -1089,6 +1108,17 @@ bool Map::UnloadGrid(const uint32 &x, const uint32 &y, bool pForce)
         DoDelayedMovesAndRemoves();
 
         unloader.UnloadN();
+
+        GridUnloadRecordMap::iterator rec = m_gridUnloadRecords.find(grid->GetGridId());
+        if (rec != m_gridUnloadRecords.end())
+            rec->second.unloadTime = sWorld.GetGameTime();
+        else if (sWorld.getConfig(CONFIG_GRID_UNLOAD_HYSTERESIS))
+        {
+            GridUnloadRecord& newRec = m_gridUnloadRecords[grid->GetGridId()];
+            newRec.unloadTime = sWorld.GetGameTime();
+            newRec.delayFactor = 1;
+        }
+
         delete getNGrid(x, y);
         setNGrid(NULL, x, y);
     }
@@ -1101,22 +1131,88 @@ bool Map::UnloadGrid(const uint32 &x, const uint32 &y, bool pForce)
     {
         if (i_InstanceId == 0)
         {
-            if(GridMaps[gx][gy])
-            {
-                GridMaps[gx][gy]->unloadData();
-                delete GridMaps[gx][gy];
-            }
-            VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(GetId(), gx, gy);
+            if (GridMaps[gx][gy] && sWorld.getConfig(CONFIG_GRID_TERRAIN_CACHE))
+                CacheGridMap(gx, gy);
+            else
+                UnloadGridMap(gx, gy);
         }
         else
+        {
             ((MapInstanced*)m_parentMap)->RemoveGridMapReference(GridPair(gx, gy));
-
-        GridMaps[gx][gy] = NULL;
+            GridMaps[gx][gy] = NULL;
+        }
     }
     DEBUG_LOG("Unloading grid[%u,%u] for map %u finished", x,y, i_id);
     return true;
 }
 
+void Map::UnloadGridMap(int gx, int gy)
+{
+    if(GridMaps[gx][gy])
+    {
+        GridMaps[gx][gy]->unloadData();
+        delete GridMaps[gx][gy];
+    }
+    VMAP::VMapFactory::createOrGetVMapManager()->unloadMap(GetId(), gx, gy);
+
+    GridMaps[gx][gy] = NULL;
+}
+
+void Map::CacheGridMap(int gx, int gy)
+{
+    m_cachedGridMaps.push_front(gx*MAX_NUMBER_OF_GRIDS + gy);
+    m_cachedGridMapsSize += GridMaps[gx][gy]->getDataSize();
+
+    // the least recently unloaded go first, the vmap tile goes with its terrain
+    uint32 limit = sWorld.getConfig(CONFIG_GRID_TERRAIN_CACHE) * 1024 * 1024;
+    while (m_cachedGridMapsSize > limit)
+    {
+        uint32 idx = m_cachedGridMaps.back();
+        m_cachedGridMaps.pop_back();
+
+        int cgx = idx / MAX_NUMBER_OF_GRIDS;
+        int cgy = idx % MAX_NUMBER_OF_GRIDS;
+        m_cachedGridMapsSize -= GridMaps[cgx][cgy]->getDataSize();
+        UnloadGridMap(cgx, cgy);
+        DEBUG_LOG("Terrain of grid[%u,%u] for map %u dropped from cache", (MAX_NUMBER_OF_GRIDS - 1) - cgx, (MAX_NUMBER_OF_GRIDS - 1) - cgy, i_id);
+    }
+}
+
+void Map::UncacheGridMap(int gx, int gy)
+{
+    CachedGridMapList::iterator itr = std::find(m_cachedGridMaps.begin(), m_cachedGridMaps.end(), uint32(gx*MAX_NUMBER_OF_GRIDS + gy));
+    if (itr == m_cachedGridMaps.end())
+        return;
+
+    m_cachedGridMaps.erase(itr);
+    m_cachedGridMapsSize -= GridMaps[gx][gy]->getDataSize();
+    DEBUG_LOG("Terrain of grid[%u,%u] for map %u reused from cache", (MAX_NUMBER_OF_GRIDS - 1) - gx, (MAX_NUMBER_OF_GRIDS - 1) - gy, i_id);
+}
+
+uint32 Map::GetGridUnloadFactor(uint32 gridId) const
+{
+    GridUnloadRecordMap::const_iterator rec = m_gridUnloadRecords.find(gridId);
+    return rec != m_gridUnloadRecords.end() ? rec->second.delayFactor : 1;
+}
+
+void Map::UpdateGridUnloadFactor(uint32 gridId)
+{
+    GridUnloadRecordMap::iterator rec = m_gridUnloadRecords.find(gridId);
+    if (rec == m_gridUnloadRecords.end())
+        return;
+
+    // loaded again soon: stay twice as long before the next unload, else back to normal
+    if (time_t(rec->second.unloadTime + sWorld.getConfig(CONFIG_GRID_UNLOAD_HYSTERESIS)) > sWorld.GetGameTime())
+    {
+        if (rec->second.delayFactor < MAX_GRID_UNLOAD_FACTOR)
+            rec->second.delayFactor *= 2;
+        rec->second.unloadTime = 0;
+        DEBUG_LOG("Grid id %u for map %u reloaded after short unload, unload delay x%u", gridId, i_id, rec->second.delayFactor);
+    }
+    else
+        m_gridUnloadRecords.erase(rec);
+}
+
 void Map::UnloadAll(bool pForce)
 {
     // clear all delayed moves, useless anyway do this moves before map unload.
@@ -1128,6 +1224,11 @@ void Map::UnloadAll(bool pForce)
         ++i;
         UnloadGrid(grid.getX(), grid.getY(), pForce);       // deletes the grid and removes it from the GridRefManager
     }
+
+    for (CachedGridMapList::const_iterator itr = m_cachedGridMaps.begin(); itr != m_cachedGridMaps.end(); ++itr)
+        UnloadGridMap(*itr / MAX_NUMBER_OF_GRIDS, *itr % MAX_NUMBER_OF_GRIDS);
+    m_cachedGridMaps.clear();
+    m_cachedGridMapsSize = 0;
 }
 
 MapDifficulty const* Map::GetMapDifficulty() const
@@ -1180,6 +1281,8 @@ GridMap::GridMap()
     m_liquidLevel = INVALID_HEIGHT;
     m_liquid_type = NULL;
     m_liquid_map  = NULL;
+    m_walkable    = NULL;
+    m_dataSize    = 0;
 }
 
 GridMap::~GridMap()
@@ -1223,6 +1326,10 @@ bool GridMap::loadData(char *filename)
             return false;
         }
         fclose(in);
+        buildWalkableData();
+        m_dataSize = header.areaMapSize + header.heightMapSize + header.liquidMapSize;
+        if (m_walkable)
+            m_dataSize += MAP_RESOLUTION*MAP_RESOLUTION/8;
         return true;
     }
     sLog.outError("Map file '%s' is non-compatible version (outdated?). Please, create new using ad.exe program.", filename);
@@ -1237,14 +1344,63 @@ void GridMap::unloadData()
     if (m_V8) delete[] m_V8;
     if (m_liquid_type) delete[] m_liquid_type;
     if (m_liquid_map) delete[] m_liquid_map;
+    if (m_walkable) delete[] m_walkable;
     m_area_map = NULL;
     m_V9 = NULL;
     m_V8 = NULL;
     m_liquid_type = NULL;
     m_liquid_map  = NULL;
+    m_walkable = NULL;
+    m_dataSize = 0;
     m_gridGetHeight = &GridMap::getHeightFromFlat;
 }
 
+float GridMap::getV9Height(uint32 index) const
+{
+    if (m_gridGetHeight == &GridMap::getHeightFromUint16)
+        return m_uint16_V9[index] * m_gridIntHeightMultiplier + m_gridHeight;
+    if (m_gridGetHeight == &GridMap::getHeightFromUint8)
+        return m_uint8_V9[index] * m_gridIntHeightMultiplier + m_gridHeight;
+    return m_V9[index];
+}
+
+float GridMap::getV8Height(uint32 index) const
+{
+    if (m_gridGetHeight == &GridMap::getHeightFromUint16)
+        return m_uint16_V8[index] * m_gridIntHeightMultiplier + m_gridHeight;
+    if (m_gridGetHeight == &GridMap::getHeightFromUint8)
+        return m_uint8_V8[index] * m_gridIntHeightMultiplier + m_gridHeight;
+    return m_V8[index];
+}
+
+void GridMap::buildWalkableData()
+{
+    if (!m_V9 || !m_V8)
+        return;
+
+    // corners are half a cell diagonal away from the center
+    const float maxRise = MAP_WALKABLE_MAX_SLOPE * (SIZE_OF_GRIDS / MAP_RESOLUTION) * 0.7072f;
+
+    m_walkable = new uint8[MAP_RESOLUTION*MAP_RESOLUTION/8];
+    memset(m_walkable, 0, MAP_RESOLUTION*MAP_RESOLUTION/8);
+
+    for (uint32 x = 0; x < MAP_RESOLUTION; ++x)
+    {
+        for (uint32 y = 0; y < MAP_RESOLUTION; ++y)
+        {
+            float center = getV8Height(x*MAP_RESOLUTION + y);
+            uint32 corner = x*(MAP_RESOLUTION + 1) + y;
+            if (fabs(getV9Height(corner) - center) > maxRise ||
+                fabs(getV9Height(corner + 1) - center) > maxRise ||
+                fabs(getV9Height(corner + MAP_RESOLUTION + 1) - center) > maxRise ||
+                fabs(getV9Height(corner + MAP_RESOLUTION + 2) - center) > maxRise)
+                continue;
+
+            m_walkable[(x*MAP_RESOLUTION + y) >> 3] |= 1 << (y & 7);
+        }
+    }
+}
+
 bool GridMap::loadAreaData(FILE *in, uint32 offset, uint32 size)
 {
     map_areaHeader header;
@@ -2055,6 +2211,8 @@ void Map::PlayerRelocationNotify( Player* player, Cell cell, CellPair cellpair )
 
 void Map::CreatureRelocationNotify(Creature *creature, Cell cell, CellPair cellpair)
 {
+    creature->SetRelocationNotifyPos(creature->GetPositionX(), creature->GetPositionY());
+
     CellLock<ReadGuard> cell_lock(cell, cellpair);
     MaNGOS::CreatureRelocationNotifier relocationNotifier(*creature);
     cell.data.Part.reserved = ALL_DISTRICT;
@@ -3544,21 +3702,28 @@ WorldObject* Map::GetWorldObject(uint64 guid)
 
 void Map::SendObjectUpdates()
 {
-    UpdateDataMapType update_players;
-
     while(!i_objectsToClientUpdate.empty())
     {
         Object* obj = *i_objectsToClientUpdate.begin();
         i_objectsToClientUpdate.erase(i_objectsToClientUpdate.begin());
-        obj->BuildUpdateData(update_players);
+        obj->BuildUpdateData(m_objectUpdatePlayers);
     }
 
     WorldPacket packet;                                     // here we allocate a std::vector with a size of 0x10000
-    for(UpdateDataMapType::iterator iter = update_players.begin(); iter != update_players.end(); ++iter)
+    for(UpdateDataMapType::iterator iter = m_objectUpdatePlayers.begin(); iter != m_objectUpdatePlayers.end();)
     {
+        // not updated since the last call, the player may be gone already
+        if (!iter->second.HasData())
+        {
+            m_objectUpdatePlayers.erase(iter++);
+            continue;
+        }
+
         iter->second.BuildPacket(&packet);
         iter->first->GetSession()->SendPacket(&packet);
         packet.clear();                                     // clean the string
+        iter->second.Clear();
+        ++iter;
     }
 }
 
@@ -32,7 +32,9 @@
 #include "SharedDefines.h"
 #include "GameSystem/GridRefManager.h"
 #include "MapRefManager.h"
+#include "PathFinder.h"
 #include "Utilities/TypeList.h"
+#include "Utilities/UnorderedMap.h"
 
 #include <bitset>
 #include <list>
@@ -139,6 +141,9 @@ enum ZLiquidStatus
 #define MAP_LIQUID_TYPE_DARK_WATER  0x10
 #define MAP_LIQUID_TYPE_WMO_WATER   0x20
 
+// max terrain rise per yard a unit can walk, about 50 degrees
+#define MAP_WALKABLE_MAX_SLOPE      1.2f
+
 struct LiquidData
 {
     uint32 type;
@@ -174,10 +179,17 @@ class GridMap
     float   m_liquidLevel;
     uint8  *m_liquid_type;
     float  *m_liquid_map;
+    // Walkable data, one bit per height cell
+    uint8  *m_walkable;
+    // Bytes allocated for all of the above
+    uint32  m_dataSize;
 
     bool  loadAreaData(FILE *in, uint32 offset, uint32 size);
     bool  loadHeightData(FILE *in, uint32 offset, uint32 size);
     bool  loadLiquidData(FILE *in, uint32 offset, uint32 size);
+    void  buildWalkableData();
+    float getV9Height(uint32 index) const;
+    float getV8Height(uint32 index) const;
 
     // Get height functions and pointers
     typedef float (GridMap::*pGetHeightPtr) (float x, float y) const;
@@ -192,9 +204,12 @@ public:
     ~GridMap();
     bool  loadData(char *filaname);
     void  unloadData();
+    uint32 getDataSize() const { return m_dataSize; }
 
     uint16 getArea(float x, float y);
     inline float getHeight(float x, float y) {return (this->*m_gridGetHeight)(x, y);}
+    // cell indexes as in height data, 0..MAP_RESOLUTION-1; grids without height data are walkable everywhere
+    bool  isWalkable(uint32 x, uint32 y) const { return !m_walkable || (m_walkable[(x*MAP_RESOLUTION + y) >> 3] & (1 << (y & 7))); }
     float  getLiquidLevel(float x, float y);
     uint8  getTerrainType(float x, float y);
     ZLiquidStatus getLiquidStatus(float x, float y, float z, uint8 ReqLiquidType, LiquidData *data = 0);
@@ -277,8 +292,9 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         //function for setting up visibility distance for maps on per-type/per-Id basis
         virtual void InitVisibilityDistance();
 
-        void PlayerRelocation(Player *, float x, float y, float z, float angl);
-        void CreatureRelocation(Creature *creature, float x, float y, float z, float orientation);
+        void PlayerRelocation(Player *, float x, float y, float z, float angl, bool lazyNotify = false);
+        // lazyNotify: along a movement, the notifiers are called only again after some distance or at a cell change
+        void CreatureRelocation(Creature *creature, float x, float y, float z, float orientation, bool lazyNotify = false);
 
         template<class LOCK_TYPE, class T, class CONTAINER> void Visit(const CellLock<LOCK_TYPE> &cell, TypeContainerVisitor<T, CONTAINER> &visitor);
 
@@ -302,7 +318,7 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
 
         void ResetGridExpiry(NGridType &grid, float factor = 1) const
         {
-            grid.ResetTimeTracker((time_t)((float)i_gridExpiry*factor));
+            grid.ResetTimeTracker((time_t)((float)i_gridExpiry*factor*GetGridUnloadFactor(grid.GetGridId())));
         }
 
         time_t GetGridExpiry(void) const { return i_gridExpiry; }
@@ -316,6 +332,10 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
 
         Map const * GetParent() const { return m_parentMap; }
 
+        // terrain of the grid if it is loaded already, never loads it
+        GridMap* GetLoadedGridMap(uint32 gx, uint32 gy) const { return GridMaps[gx][gy]; }
+        PathFinder& GetPathFinder() { return m_pathFinder; }
+
         // some calls like isInWater should not use vmaps due to processor power
         // can return INVALID_HEIGHT if under z+2 z coord not found height
         float GetHeight(float x, float y, float z, bool pCheckVMap=true) const;
@@ -457,6 +477,15 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         void LoadMap(int gx,int gy, bool reload = false);
         GridMap *GetGrid(float x, float y);
 
+        // terrain and vmap data of unloaded grids, kept in base maps up to GridUnload.TerrainCache
+        void CacheGridMap(int gx, int gy);
+        void UncacheGridMap(int gx, int gy);
+        void UnloadGridMap(int gx, int gy);
+
+        // grids loaded again soon after unload stay longer before the next unload
+        uint32 GetGridUnloadFactor(uint32 gridId) const;
+        void UpdateGridUnloadFactor(uint32 gridId);
+
         void SetTimer(uint32 t) { i_gridExpiry = t < MIN_GRID_DELAY ? MIN_GRID_DELAY : t; }
 
         void SendInitSelf( Player * player );
@@ -497,6 +526,8 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
 
         void SendObjectUpdates();
         std::set<Object *> i_objectsToClientUpdate;
+        // kept between calls with the buffers of players updated each tick
+        UpdateDataMapType m_objectUpdatePlayers;
     protected:
         void SetUnloadReferenceLock(const GridPair &p, bool on) { getNGrid(p.x_coord, p.y_coord)->setUnloadReferenceLock(on); }
 
@@ -516,6 +547,7 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
         ActiveNonPlayers m_activeNonPlayers;
         ActiveNonPlayers::iterator m_activeNonPlayersIter;
         TypeUnorderedMapContainer<AllMapStoredObjectTypes> m_objectsStore;
+        PathFinder m_pathFinder;
     private:
         time_t i_gridExpiry;
 
@@ -528,6 +560,19 @@ class MANGOS_DLL_SPEC Map : public GridRefManager<NGridType>, public MaNGOS::Obj
 
         NGridType* i_grids[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
         GridMap *GridMaps[MAX_NUMBER_OF_GRIDS][MAX_NUMBER_OF_GRIDS];
+
+        // GridMaps indexes (gx*MAX_NUMBER_OF_GRIDS+gy) without grid, most recently unloaded first
+        typedef std::list<uint32> CachedGridMapList;
+        CachedGridMapList m_cachedGridMaps;
+        uint32 m_cachedGridMapsSize;
+
+        struct GridUnloadRecord
+        {
+            time_t unloadTime;                              // 0 while loaded
+            uint32 delayFactor;
+        };
+        typedef UNORDERED_MAP<uint32, GridUnloadRecord> GridUnloadRecordMap;
+        GridUnloadRecordMap m_gridUnloadRecords;            // by grid id, only grids unloaded before
         std::bitset<TOTAL_NUMBER_OF_CELLS_PER_MAP*TOTAL_NUMBER_OF_CELLS_PER_MAP> marked_cells;
 
         std::set<WorldObject *> i_objectsToRemove;
@@ -69,7 +69,6 @@ Object::Object( ) : m_PackGUID(sizeof(uint64)+1)
     m_objectType        = TYPEMASK_OBJECT;
 
     m_uint32Values      = 0;
-    m_uint32Values_mirror = 0;
     m_valuesCount       = 0;
 
     m_inWorld           = false;
@@ -98,7 +97,6 @@ Object::~Object( )
 
         //DEBUG_LOG("Object desctr 1 check (%p)",(void*)this);
         delete [] m_uint32Values;
-        delete [] m_uint32Values_mirror;
         //DEBUG_LOG("Object desctr 2 check (%p)",(void*)this);
     }
 }
@@ -108,8 +106,7 @@ void Object::_InitValues()
     m_uint32Values = new uint32[ m_valuesCount ];
     memset(m_uint32Values, 0, m_valuesCount*sizeof(uint32));
 
-    m_uint32Values_mirror = new uint32[ m_valuesCount ];
-    memset(m_uint32Values_mirror, 0, m_valuesCount*sizeof(uint32));
+    m_changedValues.SetCount(m_valuesCount);
 
     m_objectUpdated = false;
 }
@@ -127,14 +124,12 @@ void Object::_Create( uint32 guidlow, uint32 entry, HighGuid guidhigh )
 
 void Object::BuildMovementUpdateBlock(UpdateData * data, uint32 flags ) const
 {
-    ByteBuffer buf(500);
+    ByteBuffer& buf = data->AddUpdateBlock();
 
     buf << uint8( UPDATETYPE_MOVEMENT );
     buf.append(GetPackGUID());
 
     BuildMovementUpdate(&buf, flags, 0x00000000);
-
-    data->AddUpdateBlock(buf);
 }
 
 void Object::BuildCreateUpdateBlockForPlayer(UpdateData *data, Player *target) const
@@ -188,7 +183,7 @@ void Object::BuildCreateUpdateBlockForPlayer(UpdateData *data, Player *target) c
 
     //sLog.outDebug("BuildCreateUpdate: update-type: %u, object-type: %u got flags: %X, flags2: %X", updatetype, m_objectTypeId, flags, flags2);
 
-    ByteBuffer buf(500);
+    ByteBuffer& buf = data->AddUpdateBlock();
     buf << (uint8)updatetype;
     buf.append(GetPackGUID());
     buf << (uint8)m_objectTypeId;
@@ -199,7 +194,6 @@ void Object::BuildCreateUpdateBlockForPlayer(UpdateData *data, Player *target) c
     updateMask.SetCount( m_valuesCount );
     _SetCreateBits( &updateMask, target );
     BuildValuesUpdate(updatetype, &buf, &updateMask, target);
-    data->AddUpdateBlock(buf);
 }
 
 void Object::SendCreateUpdateToPlayer(Player* player)
@@ -215,7 +209,7 @@ void Object::SendCreateUpdateToPlayer(Player* player)
 
 void Object::BuildValuesUpdateBlockForPlayer(UpdateData *data, Player *target) const
 {
-    ByteBuffer buf(500);
+    ByteBuffer& buf = data->AddUpdateBlock();
 
     buf << (uint8) UPDATETYPE_VALUES;
     buf.append(GetPackGUID());
@@ -225,8 +219,6 @@ void Object::BuildValuesUpdateBlockForPlayer(UpdateData *data, Player *target) c
 
     _SetUpdateBits( &updateMask, target );
     BuildValuesUpdate(UPDATETYPE_VALUES, &buf, &updateMask, target);
-
-    data->AddUpdateBlock(buf);
 }
 
 void Object::BuildOutOfRangeUpdateBlock(UpdateData * data) const
@@ -648,147 +640,131 @@ void Object::BuildValuesUpdate(uint8 updatetype, ByteBuffer * data, UpdateMask *
     // 2 specialized loops for speed optimization in non-unit case
     if(isType(TYPEMASK_UNIT))                               // unit (creature/player) case
     {
-        for( uint16 index = 0; index < m_valuesCount; ++index )
+        for( uint16 index = updateMask->GetNextSetBit(0); index < m_valuesCount; index = updateMask->GetNextSetBit(index + 1) )
         {
-            if( updateMask->GetBit( index ) )
+            if( index == UNIT_NPC_FLAGS )
             {
-                if( index == UNIT_NPC_FLAGS )
+                // remove custom flag before sending
+                uint32 appendValue = m_uint32Values[ index ] & ~UNIT_NPC_FLAG_GUARD;
+
+                if (GetTypeId() == TYPEID_UNIT)
                 {
-                    // remove custom flag before sending
-                    uint32 appendValue = m_uint32Values[ index ] & ~UNIT_NPC_FLAG_GUARD;
+                    if (!target->canSeeSpellClickOn((Creature*)this))
+                        appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
 
-                    if (GetTypeId() == TYPEID_UNIT)
+                    if (appendValue & UNIT_NPC_FLAG_TRAINER)
                     {
-                        if (!target->canSeeSpellClickOn((Creature*)this))
-                            appendValue &= ~UNIT_NPC_FLAG_SPELLCLICK;
-
-                        if (appendValue & UNIT_NPC_FLAG_TRAINER)
-                        {
-                            if (!((Creature*)this)->isCanTrainingOf(target, false))
-                                appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
-                        }
-
-                        if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
-                        {
-                            if (target->getClass() != CLASS_HUNTER)
-                                appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
-                        }
+                        if (!((Creature*)this)->isCanTrainingOf(target, false))
+                            appendValue &= ~(UNIT_NPC_FLAG_TRAINER | UNIT_NPC_FLAG_TRAINER_CLASS | UNIT_NPC_FLAG_TRAINER_PROFESSION);
                     }
 
-                    *data << uint32(appendValue);
-                }
-                else if (index == UNIT_FIELD_AURASTATE)
-                {
-                    if(IsPerCasterAuraState)
+                    if (appendValue & UNIT_NPC_FLAG_STABLEMASTER)
                     {
-                        // IsPerCasterAuraState set if related pet caster aura state set already
-                        if (((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE,target->GetGUID()))
-                            *data << m_uint32Values[ index ];
-                        else
-                            *data << (m_uint32Values[ index ] & ~(1 << (AURA_STATE_CONFLAGRATE-1)));
+                        if (target->getClass() != CLASS_HUNTER)
+                            appendValue &= ~UNIT_NPC_FLAG_STABLEMASTER;
                     }
-                    else
-                        *data << m_uint32Values[ index ];
-                }
-                // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
-                else if(index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
-                {
-                    // convert from float to uint32 and send
-                    *data << uint32(m_floatValues[ index ] < 0 ? 0 : m_floatValues[ index ]);
                 }
-                // there are some float values which may be negative or can't get negative due to other checks
-                else if ((index >= UNIT_FIELD_NEGSTAT0   && index <= UNIT_FIELD_NEGSTAT4) ||
-                    (index >= UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
-                    (index >= UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
-                    (index >= UNIT_FIELD_POSSTAT0   && index <= UNIT_FIELD_POSSTAT4))
-                {
-                    *data << uint32(m_floatValues[ index ]);
-                }
-                // Gamemasters should be always able to select units - remove not selectable flag
-                else if(index == UNIT_FIELD_FLAGS && target->isGameMaster())
-                {
-                    *data << (m_uint32Values[ index ] & ~UNIT_FLAG_NOT_SELECTABLE);
-                }
-                // hide lootable animation for unallowed players
-                else if(index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
+
+                *data << uint32(appendValue);
+            }
+            else if (index == UNIT_FIELD_AURASTATE)
+            {
+                if(IsPerCasterAuraState)
                 {
-                    if(!target->isAllowedToLoot((Creature*)this))
-                        *data << (m_uint32Values[ index ] & ~UNIT_DYNFLAG_LOOTABLE);
+                    // IsPerCasterAuraState set if related pet caster aura state set already
+                    if (((Unit*)this)->HasAuraStateForCaster(AURA_STATE_CONFLAGRATE,target->GetGUID()))
+                        *data << m_uint32Values[ index ];
                     else
-                        *data << (m_uint32Values[ index ] & ~UNIT_DYNFLAG_OTHER_TAGGER);
+                        *data << (m_uint32Values[ index ] & ~(1 << (AURA_STATE_CONFLAGRATE-1)));
                 }
                 else
-                {
-                    // send in current format (float as float, uint32 as uint32)
                     *data << m_uint32Values[ index ];
-                }
+            }
+            // FIXME: Some values at server stored in float format but must be sent to client in uint32 format
+            else if(index >= UNIT_FIELD_BASEATTACKTIME && index <= UNIT_FIELD_RANGEDATTACKTIME)
+            {
+                // convert from float to uint32 and send
+                *data << uint32(m_floatValues[ index ] < 0 ? 0 : m_floatValues[ index ]);
+            }
+            // there are some float values which may be negative or can't get negative due to other checks
+            else if ((index >= UNIT_FIELD_NEGSTAT0   && index <= UNIT_FIELD_NEGSTAT4) ||
+                (index >= UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSPOSITIVE + 6)) ||
+                (index >= UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE  && index <= (UNIT_FIELD_RESISTANCEBUFFMODSNEGATIVE + 6)) ||
+                (index >= UNIT_FIELD_POSSTAT0   && index <= UNIT_FIELD_POSSTAT4))
+            {
+                *data << uint32(m_floatValues[ index ]);
+            }
+            // Gamemasters should be always able to select units - remove not selectable flag
+            else if(index == UNIT_FIELD_FLAGS && target->isGameMaster())
+            {
+                *data << (m_uint32Values[ index ] & ~UNIT_FLAG_NOT_SELECTABLE);
+            }
+            // hide lootable animation for unallowed players
+            else if(index == UNIT_DYNAMIC_FLAGS && GetTypeId() == TYPEID_UNIT)
+            {
+                if(!target->isAllowedToLoot((Creature*)this))
+                    *data << (m_uint32Values[ index ] & ~UNIT_DYNFLAG_LOOTABLE);
+                else
+                    *data << (m_uint32Values[ index ] & ~UNIT_DYNFLAG_OTHER_TAGGER);
+            }
+            else
+            {
+                // send in current format (float as float, uint32 as uint32)
+                *data << m_uint32Values[ index ];
             }
         }
     }
     else if(isType(TYPEMASK_GAMEOBJECT))                    // gameobject case
     {
-        for( uint16 index = 0; index < m_valuesCount; ++index )
+        for( uint16 index = updateMask->GetNextSetBit(0); index < m_valuesCount; index = updateMask->GetNextSetBit(index + 1) )
         {
-            if( updateMask->GetBit( index ) )
+            // send in current format (float as float, uint32 as uint32)
+            if ( index == GAMEOBJECT_DYNAMIC )
             {
-                // send in current format (float as float, uint32 as uint32)
-                if ( index == GAMEOBJECT_DYNAMIC )
+                if(IsActivateToQuest )
                 {
-                    if(IsActivateToQuest )
+                    switch(((GameObject*)this)->GetGoType())
                     {
-                        switch(((GameObject*)this)->GetGoType())
-                        {
-                            case GAMEOBJECT_TYPE_CHEST:
-                                // enable quest object. Represent 9, but 1 for client before 2.3.0
-                                *data << uint16(9);
-                                *data << uint16(-1);
-                                break;
-                            case GAMEOBJECT_TYPE_GOOBER:
-                                *data << uint16(1);
-                                *data << uint16(-1);
-                                break;
-                            default:
-                                // unknown, not happen.
-                                *data << uint16(0);
-                                *data << uint16(-1);
-                                break;
-                        }
-                    }
-                    else
-                    {
-                        // disable quest object
-                        *data << uint16(0);
-                        *data << uint16(-1);
+                        case GAMEOBJECT_TYPE_CHEST:
+                            // enable quest object. Represent 9, but 1 for client before 2.3.0
+                            *data << uint16(9);
+                            *data << uint16(-1);
+                            break;
+                        case GAMEOBJECT_TYPE_GOOBER:
+                            *data << uint16(1);
+                            *data << uint16(-1);
+                            break;
+                        default:
+                            // unknown, not happen.
+                            *data << uint16(0);
+                            *data << uint16(-1);
+                            break;
                     }
                 }
                 else
-                    *data << m_uint32Values[ index ];       // other cases
+                {
+                    // disable quest object
+                    *data << uint16(0);
+                    *data << uint16(-1);
+                }
             }
+            else
+                *data << m_uint32Values[ index ];       // other cases
         }
     }
     else                                                    // other objects case (no special index checks)
     {
-        for( uint16 index = 0; index < m_valuesCount; ++index )
+        for( uint16 index = updateMask->GetNextSetBit(0); index < m_valuesCount; index = updateMask->GetNextSetBit(index + 1) )
         {
-            if( updateMask->GetBit( index ) )
-            {
-                // send in current format (float as float, uint32 as uint32)
-                *data << m_uint32Values[ index ];
-            }
+            // send in current format (float as float, uint32 as uint32)
+            *data << m_uint32Values[ index ];
         }
     }
 }
 
 void Object::ClearUpdateMask(bool remove)
 {
-    if(m_uint32Values)
-    {
-        for( uint16 index = 0; index < m_valuesCount; ++index )
-        {
-            if(m_uint32Values_mirror[index]!= m_uint32Values[index])
-                m_uint32Values_mirror[index] = m_uint32Values[index];
-        }
-    }
+    m_changedValues.Clear();
 
     if(m_objectUpdated)
     {
@@ -819,11 +795,7 @@ bool Object::LoadValues(const char* data)
 
 void Object::_SetUpdateBits(UpdateMask *updateMask, Player* /*target*/) const
 {
-    for( uint16 index = 0; index < m_valuesCount; ++index )
-    {
-        if(m_uint32Values_mirror[index]!= m_uint32Values[index])
-            updateMask->SetBit(index);
-    }
+    *updateMask |= m_changedValues;
 }
 
 void Object::_SetCreateBits(UpdateMask *updateMask, Player* /*target*/) const
@@ -842,6 +814,7 @@ void Object::SetInt32Value( uint16 index, int32 value )
     if(m_int32Values[ index ] != value)
     {
         m_int32Values[ index ] = value;
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -861,6 +834,7 @@ void Object::SetUInt32Value( uint16 index, uint32 value )
     if(m_uint32Values[ index ] != value)
     {
         m_uint32Values[ index ] = value;
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -880,6 +854,8 @@ void Object::SetUInt64Value( uint16 index, const uint64 &value )
     {
         m_uint32Values[ index ] = *((uint32*)&value);
         m_uint32Values[ index + 1 ] = *(((uint32*)&value) + 1);
+        m_changedValues.SetBit(index);
+        m_changedValues.SetBit(index + 1);
 
         if(m_inWorld)
         {
@@ -899,6 +875,7 @@ void Object::SetFloatValue( uint16 index, float value )
     if(m_floatValues[ index ] != value)
     {
         m_floatValues[ index ] = value;
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -925,6 +902,7 @@ void Object::SetByteValue( uint16 index, uint8 offset, uint8 value )
     {
         m_uint32Values[ index ] &= ~uint32(uint32(0xFF) << (offset * 8));
         m_uint32Values[ index ] |= uint32(uint32(value) << (offset * 8));
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -951,6 +929,7 @@ void Object::SetUInt16Value( uint16 index, uint8 offset, uint16 value )
     {
         m_uint32Values[ index ] &= ~uint32(uint32(0xFFFF) << (offset * 16));
         m_uint32Values[ index ] |= uint32(uint32(value) << (offset * 16));
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -1020,6 +999,7 @@ void Object::SetFlag( uint16 index, uint32 newFlag )
     if(oldval != newval)
     {
         m_uint32Values[ index ] = newval;
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -1041,6 +1021,7 @@ void Object::RemoveFlag( uint16 index, uint32 oldFlag )
     if(oldval != newval)
     {
         m_uint32Values[ index ] = newval;
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -1066,6 +1047,7 @@ void Object::SetByteFlag( uint16 index, uint8 offset, uint8 newFlag )
     if(!(uint8(m_uint32Values[ index ] >> (offset * 8)) & newFlag))
     {
         m_uint32Values[ index ] |= uint32(uint32(newFlag) << (offset * 8));
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -1091,6 +1073,7 @@ void Object::RemoveByteFlag( uint16 index, uint8 offset, uint8 oldFlag )
     if(uint8(m_uint32Values[ index ] >> (offset * 8)) & oldFlag)
     {
         m_uint32Values[ index ] &= ~uint32(uint32(oldFlag) << (offset * 8));
+        m_changedValues.SetBit(index);
 
         if(m_inWorld)
         {
@@ -1285,6 +1268,46 @@ bool WorldObject::IsWithinLOS(float ox, float oy, float oz) const
     return vMapManager->isInLineOfSight(GetMapId(), x, y, z+2.0f, ox, oy, oz+2.0f);
 }
 
+/// Same as erasing every unit failing IsWithinLOSInMap, with one vmap call for all of them
+void WorldObject::RemoveNotWithinLOSInMap(std::list<Unit*>& units) const
+{
+    std::vector<float> targets;
+    targets.reserve(units.size() * 3);
+
+    for(std::list<Unit*>::iterator itr = units.begin(); itr != units.end();)
+    {
+        if (!IsInMap(*itr))
+        {
+            itr = units.erase(itr);
+            continue;
+        }
+
+        targets.push_back((*itr)->GetPositionX());
+        targets.push_back((*itr)->GetPositionY());
+        targets.push_back((*itr)->GetPositionZ() + 2.0f);
+        ++itr;
+    }
+
+    if (units.empty())
+        return;
+
+    bool* results = new bool[units.size()];
+
+    VMAP::IVMapManager *vMapManager = VMAP::VMapFactory::createOrGetVMapManager();
+    vMapManager->isInLineOfSight(GetMapId(), GetPositionX(), GetPositionY(), GetPositionZ() + 2.0f, &targets[0], units.size(), results);
+
+    uint32 i = 0;
+    for(std::list<Unit*>::iterator itr = units.begin(); itr != units.end(); ++i)
+    {
+        if (!results[i])
+            itr = units.erase(itr);
+        else
+            ++itr;
+    }
+
+    delete[] results;
+}
+
 bool WorldObject::GetDistanceOrder(WorldObject const* obj1, WorldObject const* obj2, bool is3D /* = true */) const
 {
     float dx1 = GetPositionX() - obj1->GetPositionX();
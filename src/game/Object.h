@@ -23,6 +23,7 @@
 #include "ByteBuffer.h"
 #include "UpdateFields.h"
 #include "UpdateData.h"
+#include "UpdateMask.h"
 #include "GameSystem/GridReference.h"
 #include "ObjectDefines.h"
 
@@ -91,8 +92,8 @@ class UpdateData;
 class WorldSession;
 class Creature;
 class Player;
+class Unit;
 class Map;
-class UpdateMask;
 class InstanceData;
 
 typedef UNORDERED_MAP<Player*, UpdateData> UpdateDataMapType;
@@ -328,7 +329,7 @@ class MANGOS_DLL_SPEC Object
             float  *m_floatValues;
         };
 
-        uint32 *m_uint32Values_mirror;
+        UpdateMask m_changedValues;                         // fields set since the last ClearUpdateMask()
 
         uint16 m_valuesCount;
 
@@ -449,6 +450,7 @@ class MANGOS_DLL_SPEC WorldObject : public Object
         }
         bool IsWithinLOS(float x, float y, float z) const;
         bool IsWithinLOSInMap(const WorldObject* obj) const;
+        void RemoveNotWithinLOSInMap(std::list<Unit*>& units) const;
         bool GetDistanceOrder(WorldObject const* obj1, WorldObject const* obj2, bool is3D = true) const;
         bool IsInRange(WorldObject const* obj, float minRange, float maxRange, bool is3D = true) const;
         bool IsInRange2d(float x, float y, float minRange, float maxRange) const;
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ObjectPool.h"
+#include "WorldSession.h"
+#include "Player.h"
+#include "Chat.h"
+#include <ace/Guard_T.h>
+
+struct ObjectPoolFreeSlot
+{
+    ObjectPoolFreeSlot* next;
+};
+
+/// Free list and counters of one thread, written only by this thread
+struct ObjectPoolThreadCache
+{
+    ObjectPoolThreadCache() : freeSlots(NULL), allocated(0), freed(0), oversized(0), chunks(0) {}
+
+    ObjectPoolFreeSlot* freeSlots;
+    uint64 allocated;
+    uint64 freed;
+    uint64 oversized;
+    uint32 chunks;
+};
+
+ObjectPool::ObjectPool(char const* name, size_t slotSize, uint32 chunkSlots) :
+    m_name(name), m_chunkSlots(chunkSlots)
+{
+    // keep slots pointer aligned and able to hold the free list link
+    if (slotSize < sizeof(ObjectPoolFreeSlot))
+        slotSize = sizeof(ObjectPoolFreeSlot);
+    m_slotSize = (slotSize + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+
+    GetPools().push_back(this);
+}
+
+ObjectPool::PoolList& ObjectPool::GetPools()
+{
+    // function static, pools are static objects of other translation units
+    static PoolList pools;
+    return pools;
+}
+
+ObjectPoolThreadCache& ObjectPool::GetThreadCache()
+{
+    ObjectPoolThreadRef* ref = m_threadRef;
+    if (!ref->cache)
+    {
+        ref->cache = new ObjectPoolThreadCache;
+
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_cachesLock, *ref->cache);
+        m_caches.push_back(ref->cache);
+    }
+
+    return *ref->cache;
+}
+
+void ObjectPool::Grow(ObjectPoolThreadCache& cache)
+{
+    char* chunk = (char*)::operator new(m_slotSize * m_chunkSlots);
+
+    for (uint32 i = 0; i < m_chunkSlots; ++i)
+    {
+        ObjectPoolFreeSlot* slot = (ObjectPoolFreeSlot*)(chunk + i * m_slotSize);
+        slot->next = cache.freeSlots;
+        cache.freeSlots = slot;
+    }
+
+    ++cache.chunks;
+}
+
+void* ObjectPool::Allocate(size_t size)
+{
+    ObjectPoolThreadCache& cache = GetThreadCache();
+    ++cache.allocated;
+
+    if (size > m_slotSize)
+    {
+        ++cache.oversized;
+        return ::operator new(size);
+    }
+
+    if (!cache.freeSlots)
+        Grow(cache);
+
+    ObjectPoolFreeSlot* slot = cache.freeSlots;
+    cache.freeSlots = slot->next;
+    return slot;
+}
+
+void ObjectPool::Free(void* p, size_t size)
+{
+    if (!p)
+        return;
+
+    ObjectPoolThreadCache& cache = GetThreadCache();
+    ++cache.freed;
+
+    if (size > m_slotSize)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    ObjectPoolFreeSlot* slot = (ObjectPoolFreeSlot*)p;
+    slot->next = cache.freeSlots;
+    cache.freeSlots = slot;
+}
+
+void ObjectPool::GetStats(ObjectPoolStats& stats)
+{
+    memset(&stats, 0, sizeof(stats));
+
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_cachesLock);
+
+    // other threads keep counting meanwhile, values are approximate
+    for (CacheList::const_iterator itr = m_caches.begin(); itr != m_caches.end(); ++itr)
+    {
+        stats.allocated += (*itr)->allocated;
+        stats.freed     += (*itr)->freed;
+        stats.oversized += (*itr)->oversized;
+        stats.chunks    += (*itr)->chunks;
+    }
+
+    stats.threads = m_caches.size();
+}
+
+void ObjectPool::SendReport(ChatHandler* handler)
+{
+    PoolList const& pools = GetPools();
+    for (PoolList::const_iterator itr = pools.begin(); itr != pools.end(); ++itr)
+    {
+        ObjectPool* pool = *itr;
+
+        ObjectPoolStats stats;
+        pool->GetStats(stats);
+
+        handler->PSendSysMessage("%s (%u bytes): " UI64FMTD " live, " UI64FMTD " allocations, %u chunks (%u KB) in %u threads, " UI64FMTD " oversized",
+            pool->GetName(), uint32(pool->GetSlotSize()), stats.allocated - stats.freed, stats.allocated, stats.chunks,
+            uint32(uint64(stats.chunks) * pool->m_chunkSlots * pool->GetSlotSize() / 1024), stats.threads, stats.oversized);
+    }
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_OBJECTPOOL_H
+#define MANGOS_OBJECTPOOL_H
+
+#include "Common.h"
+#include <ace/Thread_Mutex.h>
+#include <ace/TSS_T.h>
+
+class ChatHandler;
+
+/// Counters of one pool, summed over all threads
+struct ObjectPoolStats
+{
+    uint64 allocated;                                       // Allocate() calls
+    uint64 freed;                                           // Free() calls
+    uint64 oversized;                                       // calls passed to the global allocator, object bigger than slot
+    uint32 chunks;                                          // chunks requested from the global allocator (pool growth)
+    uint32 threads;                                         // threads that used the pool
+};
+
+struct ObjectPoolThreadCache;
+
+struct ObjectPoolThreadRef
+{
+    ObjectPoolThreadRef() : cache(NULL) {}
+
+    ObjectPoolThreadCache* cache;
+};
+
+/**
+ * Free list allocator for objects of one size created and deleted at high rate (Spell, Aura, SpellEvent).
+ *
+ * Each thread has own free list and counters, so Allocate() and Free() never
+ * take a lock: maps are updated by the world thread, objects created and
+ * deleted in map update stay in its list. An object freed by other thread
+ * than the one allocating it is simply kept in the list of the freeing thread.
+ * Pools are per thread and not per map: spells and auras move with their
+ * owner between maps, so a per map pool would get frees from objects of
+ * other maps anyway, and maps are updated by one thread. Memory is never
+ * returned to the system, the pool size follows the peak (see SendReport).
+ */
+class ObjectPool
+{
+    public:
+        ObjectPool(char const* name, size_t slotSize, uint32 chunkSlots = 64);
+
+        void* Allocate(size_t size);
+        void Free(void* p, size_t size);
+
+        char const* GetName() const { return m_name; }
+        size_t GetSlotSize() const { return m_slotSize; }
+        void GetStats(ObjectPoolStats& stats);
+
+        /// Print state of all pools to a GM
+        static void SendReport(ChatHandler* handler);
+
+    private:
+        ObjectPoolThreadCache& GetThreadCache();
+        void Grow(ObjectPoolThreadCache& cache);
+
+        typedef std::vector<ObjectPool*> PoolList;
+        static PoolList& GetPools();
+
+        char const* m_name;
+        size_t m_slotSize;
+        uint32 m_chunkSlots;
+
+        ACE_TSS<ObjectPoolThreadRef> m_threadRef;
+
+        // caches of all threads that ever used the pool, never freed
+        typedef std::vector<ObjectPoolThreadCache*> CacheList;
+        CacheList m_caches;
+        ACE_Thread_Mutex m_cachesLock;
+};
+
+/**
+ * STL allocator taking single nodes from an ObjectPool, for node based
+ * containers filled and cleared at high rate (Spell target lists).
+ * All allocators of one node type share one pool, requests for more than
+ * one element (not done by std::list) go to the global allocator.
+ */
+template<class T>
+class ObjectPoolAllocator
+{
+    public:
+        typedef T value_type;
+        typedef T* pointer;
+        typedef T const* const_pointer;
+        typedef T& reference;
+        typedef T const& const_reference;
+        typedef size_t size_type;
+        typedef ptrdiff_t difference_type;
+
+        template<class U>
+        struct rebind { typedef ObjectPoolAllocator<U> other; };
+
+        ObjectPoolAllocator() {}
+        template<class U>
+        ObjectPoolAllocator(ObjectPoolAllocator<U> const&) {}
+
+        pointer address(reference x) const { return &x; }
+        const_pointer address(const_reference x) const { return &x; }
+        size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+        pointer allocate(size_type n, void const* = 0)
+        {
+            if (n == 1)
+                return (pointer)GetPool().Allocate(sizeof(T));
+            return (pointer)::operator new(n * sizeof(T));
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            if (n == 1)
+                GetPool().Free(p, sizeof(T));
+            else
+                ::operator delete(p);
+        }
+
+        void construct(pointer p, const_reference val) { new((void*)p) T(val); }
+        void destroy(pointer p) { p->~T(); }
+
+    private:
+        static ObjectPool& GetPool()
+        {
+            // never deleted, like the other pools
+            static ObjectPool* pool = new ObjectPool("Container node", sizeof(T));
+            return *pool;
+        }
+};
+
+template<class T, class U>
+inline bool operator==(ObjectPoolAllocator<T> const&, ObjectPoolAllocator<U> const&) { return true; }
+
+template<class T, class U>
+inline bool operator!=(ObjectPoolAllocator<T> const&, ObjectPoolAllocator<U> const&) { return false; }
+
+#endif
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "OpcodeStats.h"
+#include "Policies/SingletonImp.h"
+#include "Log.h"
+#include "World.h"
+#include "WorldSession.h"
+#include "Player.h"
+#include "Chat.h"
+#include <ace/TSS_T.h>
+#include <ace/Guard_T.h>
+#include <ace/High_Res_Timer.h>
+
+#define CLASS_LOCK MaNGOS::ClassLevelLockable<OpcodeStatsMgr, ACE_Thread_Mutex>
+INSTANTIATE_SINGLETON_2(OpcodeStatsMgr, CLASS_LOCK);
+INSTANTIATE_CLASS_MUTEX(OpcodeStatsMgr, ACE_Thread_Mutex);
+
+/// Per thread pointer to the counters, the block itself outlives the thread
+struct OpcodeStatThreadBlock
+{
+    OpcodeStatThreadBlock() : block(new OpcodeStatBlock)
+    {
+        sOpcodeStats.RegisterBlock(block);
+    }
+
+    OpcodeStatBlock* block;
+};
+
+typedef ACE_TSS<OpcodeStatThreadBlock> OpcodeStatTSS;
+static OpcodeStatTSS threadBlock;
+
+namespace
+{
+    uint64 TicksToUsecs(uint64 ticks)
+    {
+        ACE_Time_Value time;
+        ACE_High_Res_Timer::hrtime_to_tv(time, ACE_hrtime_t(ticks));
+        return uint64(time.sec()) * 1000000 + time.usec();
+    }
+
+    struct OpcodeStatOrder
+    {
+        OpcodeStatOrder(OpcodeStatBlock const& stats, OpcodeStatSort sort) : m_stats(stats), m_sort(sort) {}
+
+        uint64 Key(uint32 opcode) const
+        {
+            OpcodeStatEntry const& e = m_stats.entries[opcode];
+            switch (m_sort)
+            {
+                case OPCODE_STAT_SORT_COUNT:     return e.received + e.sent;
+                case OPCODE_STAT_SORT_BYTES_IN:  return e.bytesIn;
+                case OPCODE_STAT_SORT_BYTES_OUT: return e.bytesOut;
+                default:                         return e.handlerTime;
+            }
+        }
+
+        bool operator()(uint32 a, uint32 b) const { return Key(a) > Key(b); }
+
+        OpcodeStatBlock const& m_stats;
+        OpcodeStatSort m_sort;
+    };
+
+    bool TalkerOrder(WorldSession* a, WorldSession* b)
+    {
+        return a->GetStatPackets() > b->GetStatPackets();
+    }
+
+    typedef std::vector<uint32> OpcodeList;
+
+    void SelectTopOpcodes(OpcodeStatBlock const& stats, OpcodeStatSort sort, uint32 count, OpcodeList& list)
+    {
+        OpcodeStatOrder order(stats, sort);
+
+        for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+            if (order.Key(i))
+                list.push_back(i);
+
+        if (count > list.size())
+            count = list.size();
+
+        std::partial_sort(list.begin(), list.begin() + count, list.end(), order);
+        list.resize(count);
+    }
+}
+
+OpcodeStatsMgr::OpcodeStatsMgr() : m_resetTime(time(NULL)), m_period(0)
+{
+}
+
+OpcodeStatsMgr::~OpcodeStatsMgr()
+{
+    for (BlockList::const_iterator itr = m_blocks.begin(); itr != m_blocks.end(); ++itr)
+        delete *itr;
+}
+
+OpcodeStatBlock& OpcodeStatsMgr::GetThreadBlock()
+{
+    return *threadBlock->block;
+}
+
+void OpcodeStatsMgr::RegisterBlock(OpcodeStatBlock* block)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_blocksLock);
+    m_blocks.push_back(block);
+}
+
+void OpcodeStatsMgr::Sum(OpcodeStatBlock& total)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_blocksLock);
+
+    // other threads keep counting meanwhile, each value is only read once
+    for (BlockList::const_iterator itr = m_blocks.begin(); itr != m_blocks.end(); ++itr)
+    {
+        for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+        {
+            OpcodeStatEntry const& src = (*itr)->entries[i];
+            OpcodeStatEntry& dst = total.entries[i];
+
+            dst.received    += src.received;
+            dst.bytesIn     += src.bytesIn;
+            dst.sent        += src.sent;
+            dst.bytesOut    += src.bytesOut;
+            dst.handled     += src.handled;
+            dst.handlerTime += src.handlerTime;
+            if (src.maxPeriod == m_period && src.maxHandlerTime > dst.maxHandlerTime)
+                dst.maxHandlerTime = src.maxHandlerTime;
+        }
+    }
+}
+
+void OpcodeStatsMgr::Collect(OpcodeStatBlock& total)
+{
+    Sum(total);
+
+    for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+    {
+        OpcodeStatEntry const& base = m_base.entries[i];
+        OpcodeStatEntry& dst = total.entries[i];
+
+        dst.received    -= base.received;
+        dst.bytesIn     -= base.bytesIn;
+        dst.sent        -= base.sent;
+        dst.bytesOut    -= base.bytesOut;
+        dst.handled     -= base.handled;
+        dst.handlerTime -= base.handlerTime;
+    }
+}
+
+void OpcodeStatsMgr::Reset()
+{
+    OpcodeStatBlock total;
+    Sum(total);
+
+    for (uint32 i = 0; i < NUM_MSG_TYPES; ++i)
+        m_base.entries[i] = total.entries[i];
+
+    m_resetTime = time(NULL);
+    ++m_period;
+
+    // session counters are only written by world and map updates, same thread as us
+    World::SessionMap const& sessions = sWorld.GetAllSessions();
+    for (World::SessionMap::const_iterator itr = sessions.begin(); itr != sessions.end(); ++itr)
+        itr->second->ResetStats();
+}
+
+void OpcodeStatsMgr::GetTopTalkers(SessionList& list, uint32 count)
+{
+    World::SessionMap const& sessions = sWorld.GetAllSessions();
+    for (World::SessionMap::const_iterator itr = sessions.begin(); itr != sessions.end(); ++itr)
+        if (itr->second->GetStatPackets())
+            list.push_back(itr->second);
+
+    if (count > list.size())
+        count = list.size();
+
+    std::partial_sort(list.begin(), list.begin() + count, list.end(), TalkerOrder);
+    list.resize(count);
+}
+
+void OpcodeStatsMgr::SendReport(ChatHandler* handler, uint32 count, OpcodeStatSort sort)
+{
+    OpcodeStatBlock stats;
+    Collect(stats);
+
+    OpcodeList list;
+    SelectTopOpcodes(stats, sort, count, list);
+
+    handler->PSendSysMessage("Opcode stats for the last %u sec:", uint32(time(NULL) - m_resetTime));
+
+    for (OpcodeList::const_iterator itr = list.begin(); itr != list.end(); ++itr)
+    {
+        OpcodeStatEntry const& e = stats.entries[*itr];
+        handler->PSendSysMessage("%s: in " UI64FMTD " (" UI64FMTD " bytes) out " UI64FMTD " (" UI64FMTD " bytes) handled " UI64FMTD " in " UI64FMTD " ms, max " UI64FMTD " us",
+            LookupOpcodeName(*itr), e.received, e.bytesIn, e.sent, e.bytesOut, e.handled, TicksToUsecs(e.handlerTime) / 1000, TicksToUsecs(e.maxHandlerTime));
+    }
+}
+
+void OpcodeStatsMgr::SendTopTalkers(ChatHandler* handler, uint32 count)
+{
+    SessionList list;
+    GetTopTalkers(list, count);
+
+    handler->PSendSysMessage("Top sessions by received packets for the last %u sec:", uint32(time(NULL) - m_resetTime));
+
+    for (SessionList::const_iterator itr = list.begin(); itr != list.end(); ++itr)
+    {
+        WorldSession* session = *itr;
+        handler->PSendSysMessage("Account %u (%s, player %s): %u packets, %u bytes, %u ms handler time",
+            session->GetAccountId(), session->GetRemoteAddress().c_str(), session->GetPlayerName(),
+            session->GetStatPackets(), session->GetStatBytes(), uint32(TicksToUsecs(session->GetStatHandlerTime()) / 1000));
+    }
+}
+
+void OpcodeStatsMgr::LogReport(uint32 count)
+{
+    OpcodeStatBlock stats;
+    Collect(stats);
+
+    OpcodeList list;
+    SelectTopOpcodes(stats, sWorld.getConfig(CONFIG_OPCODE_STATS_HANDLER_TIME) ? OPCODE_STAT_SORT_TIME : OPCODE_STAT_SORT_COUNT, count, list);
+
+    sLog.outString("Opcode stats for the last %u sec:", uint32(time(NULL) - m_resetTime));
+
+    for (OpcodeList::const_iterator itr = list.begin(); itr != list.end(); ++itr)
+    {
+        OpcodeStatEntry const& e = stats.entries[*itr];
+        sLog.outString("  %s: in " UI64FMTD " (" UI64FMTD " bytes) out " UI64FMTD " (" UI64FMTD " bytes) handled " UI64FMTD " in " UI64FMTD " ms, max " UI64FMTD " us",
+            LookupOpcodeName(*itr), e.received, e.bytesIn, e.sent, e.bytesOut, e.handled, TicksToUsecs(e.handlerTime) / 1000, TicksToUsecs(e.maxHandlerTime));
+    }
+
+    SessionList talkers;
+    GetTopTalkers(talkers, count);
+
+    for (SessionList::const_iterator itr = talkers.begin(); itr != talkers.end(); ++itr)
+    {
+        WorldSession* session = *itr;
+        sLog.outString("  Account %u (%s, player %s): %u packets, %u bytes, %u ms handler time",
+            session->GetAccountId(), session->GetRemoteAddress().c_str(), session->GetPlayerName(),
+            session->GetStatPackets(), session->GetStatBytes(), uint32(TicksToUsecs(session->GetStatHandlerTime()) / 1000));
+    }
+
+    Reset();
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup u2w
+/// @{
+/// \file
+
+#ifndef MANGOS_OPCODESTATS_H
+#define MANGOS_OPCODESTATS_H
+
+#include "Common.h"
+#include "Policies/Singleton.h"
+#include "Opcodes.h"
+#include <ace/Thread_Mutex.h>
+#include <ace/OS_NS_time.h>
+
+class ChatHandler;
+class WorldSession;
+
+/// Traffic and handler counters of one opcode
+struct OpcodeStatEntry
+{
+    uint64 received;                                        // packets received from clients
+    uint64 bytesIn;                                         // including the 6 byte client header
+    uint64 sent;                                            // packets sent to clients
+    uint64 bytesOut;                                        // including the 4-5 byte server header
+    uint64 handled;                                         // handler calls
+    uint64 handlerTime;                                     // sum of handler times, in high resolution timer ticks
+    uint64 maxHandlerTime;                                  // in high resolution timer ticks
+    uint32 maxPeriod;                                       // measurement period of maxHandlerTime
+};
+
+/// Counters of all opcodes, each thread writes only its own block
+struct OpcodeStatBlock
+{
+    OpcodeStatBlock() { memset(entries, 0, sizeof(entries)); }
+
+    OpcodeStatEntry entries[NUM_MSG_TYPES];
+};
+
+enum OpcodeStatSort
+{
+    OPCODE_STAT_SORT_TIME,
+    OPCODE_STAT_SORT_COUNT,
+    OPCODE_STAT_SORT_BYTES_IN,
+    OPCODE_STAT_SORT_BYTES_OUT
+};
+
+/**
+ * Always-on per-opcode network and handler statistics.
+ *
+ * Counters are kept per thread (network threads count received packets,
+ * any thread sending a packet counts sent ones, world and map updates count
+ * handler calls) and only summed when a report is requested, so the hot
+ * path is a few additions to memory no other thread writes. Handler times
+ * are read from the high resolution counter and converted only for reports.
+ */
+class OpcodeStatsMgr : public MaNGOS::Singleton<OpcodeStatsMgr, MaNGOS::ClassLevelLockable<OpcodeStatsMgr, ACE_Thread_Mutex> >
+{
+    friend class MaNGOS::OperatorNew<OpcodeStatsMgr>;
+
+    public:
+        void CountReceived(uint16 opcode, size_t size)
+        {
+            OpcodeStatEntry& e = GetThreadBlock().entries[opcode];
+            ++e.received;
+            e.bytesIn += size;
+        }
+
+        void CountSent(uint16 opcode, size_t size)
+        {
+            OpcodeStatEntry& e = GetThreadBlock().entries[opcode];
+            ++e.sent;
+            e.bytesOut += size;
+        }
+
+        void CountHandled(uint16 opcode, uint64 ticks)
+        {
+            OpcodeStatEntry& e = GetThreadBlock().entries[opcode];
+            ++e.handled;
+            e.handlerTime += ticks;
+
+            // max can't be rebased at Reset(), each period starts a new one
+            if (e.maxPeriod != m_period)
+            {
+                e.maxPeriod = m_period;
+                e.maxHandlerTime = 0;
+            }
+            if (ticks > e.maxHandlerTime)
+                e.maxHandlerTime = ticks;
+        }
+
+        /// Handler time counted in CountHandled, see OpcodeStatsHandlerTime
+        static uint64 GetHandlerClock() { return uint64(ACE_OS::gethrtime()); }
+
+        /// Sum of all threads since the last Reset()
+        void Collect(OpcodeStatBlock& total);
+
+        /// Start a new measurement period (for reports, counters are never written by other threads)
+        void Reset();
+
+        /// Print the top opcodes and sessions to a GM
+        void SendReport(ChatHandler* handler, uint32 count, OpcodeStatSort sort);
+        void SendTopTalkers(ChatHandler* handler, uint32 count);
+
+        /// Periodic dump to the server log, also starts a new period for session counters
+        void LogReport(uint32 count);
+
+    private:
+        OpcodeStatsMgr();
+        ~OpcodeStatsMgr();
+
+        OpcodeStatBlock& GetThreadBlock();
+
+        /// Raw totals of all threads
+        void Sum(OpcodeStatBlock& total);
+
+        typedef std::vector<WorldSession*> SessionList;
+        void GetTopTalkers(SessionList& list, uint32 count);
+
+        typedef std::vector<OpcodeStatBlock*> BlockList;
+
+        // blocks of all threads that ever counted something, never freed
+        BlockList m_blocks;
+        ACE_Thread_Mutex m_blocksLock;
+
+        // totals at the last Reset()
+        OpcodeStatBlock m_base;
+        time_t m_resetTime;
+        volatile uint32 m_period;                           // increased by Reset()
+
+        friend struct OpcodeStatThreadBlock;
+        void RegisterBlock(OpcodeStatBlock* block);
+};
+
+#define sOpcodeStats OpcodeStatsMgr::Instance()
+
+#endif
+/// @}
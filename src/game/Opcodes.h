@@ -1335,12 +1335,21 @@ enum SessionStatus
     STATUS_UNHANDLED                                        ///< We don' handle this opcode yet
 };
 
+/// Thread in which the opcode handler is called
+enum PacketProcessing
+{
+    PROCESS_INPLACE = 0,                                    ///< Process the packet whenever it is received (not handled and server side opcodes)
+    PROCESS_THREADUNSAFE,                                   ///< Touches global state, processed in World::UpdateSessions()
+    PROCESS_THREADSAFE                                      ///< Touches only the player's map, processed in Map::Update()
+};
+
 class WorldPacket;
 
 struct OpcodeHandler
 {
     char const* name;
     SessionStatus status;
+    PacketProcessing packetProcessing;
     void (WorldSession::*handler)(WorldPacket& recvPacket);
 };
 
@@ -0,0 +1,313 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "PathFinder.h"
+#include "Map.h"
+#include "Creature.h"
+#include "World.h"
+
+#include <algorithm>
+#include <functional>
+
+// cells over the whole map, same resolution as the height data
+#define PATH_CELLS_PER_MAP      (MAX_NUMBER_OF_GRIDS*MAP_RESOLUTION)
+#define PATH_CELL_BITS          13
+
+namespace
+{
+    inline float ToCellCoord(float c)
+    {
+        return MAP_RESOLUTION * (CENTER_GRID_ID - c / SIZE_OF_GRIDS);
+    }
+
+    inline float FromCellCoord(float c)
+    {
+        return (CENTER_GRID_ID - c / MAP_RESOLUTION) * SIZE_OF_GRIDS;
+    }
+
+    inline uint32 MakeCell(int32 cx, int32 cy)
+    {
+        return (uint32(cx) << PATH_CELL_BITS) | uint32(cy);
+    }
+
+    inline int32 CellX(uint32 cell) { return int32(cell >> PATH_CELL_BITS); }
+    inline int32 CellY(uint32 cell) { return int32(cell & ((1 << PATH_CELL_BITS) - 1)); }
+
+    // octile distance, straight steps cost 10 and diagonal ones 14
+    inline uint32 EstimateCost(int32 cx, int32 cy, uint32 endCell)
+    {
+        uint32 dx = abs(cx - CellX(endCell));
+        uint32 dy = abs(cy - CellY(endCell));
+        return dx > dy ? 10 * dx + 4 * dy : 10 * dy + 4 * dx;
+    }
+}
+
+bool PathFinder::IsWalkable(int32 cx, int32 cy) const
+{
+    if (cx < 0 || cy < 0 || cx >= PATH_CELLS_PER_MAP || cy >= PATH_CELLS_PER_MAP)
+        return false;
+
+    GridMap* gmap = m_map->GetLoadedGridMap(cx / MAP_RESOLUTION, cy / MAP_RESOLUTION);
+    return gmap && gmap->isWalkable(cx % MAP_RESOLUTION, cy % MAP_RESOLUTION);
+}
+
+bool PathFinder::IsLineWalkable(float fromX, float fromY, float toX, float toY) const
+{
+    float dx = toX - fromX;
+    float dy = toY - fromY;
+
+    // two samples per cell can't jump over one
+    uint32 steps = uint32(ceil(std::max(fabs(dx), fabs(dy)) * 2.0f));
+    for (uint32 i = 0; i <= steps; ++i)
+    {
+        float t = steps ? float(i) / steps : 0.0f;
+        if (!IsWalkable(int32(floor(fromX + dx * t)), int32(floor(fromY + dy * t))))
+            return false;
+    }
+
+    return true;
+}
+
+bool PathFinder::GetGroundHeight(float x, float y, float& z) const
+{
+    float cx = ToCellCoord(x);
+    float cy = ToCellCoord(y);
+    if (cx < 0.0f || cy < 0.0f || cx >= PATH_CELLS_PER_MAP || cy >= PATH_CELLS_PER_MAP)
+        return false;
+
+    GridMap* gmap = m_map->GetLoadedGridMap(uint32(cx) / MAP_RESOLUTION, uint32(cy) / MAP_RESOLUTION);
+    if (!gmap)
+        return false;
+
+    z = gmap->getHeight(x, y);
+    return z > INVALID_HEIGHT;
+}
+
+bool PathFinder::Calculate(Unit const& unit, float destX, float destY, float destZ, PointPath& path)
+{
+    path.clear();
+
+    if (!sWorld.getConfig(CONFIG_PATHFINDING))
+        return false;
+
+    // flying creatures don't follow the terrain, players are moved by their client
+    if (unit.GetTypeId() != TYPEID_UNIT || ((Creature const&)unit).canFly())
+        return false;
+
+    return Calculate(unit.GetPositionX(), unit.GetPositionY(), unit.GetPositionZ(), destX, destY, destZ, path);
+}
+
+bool PathFinder::Calculate(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, PointPath& path)
+{
+    path.clear();
+
+    // the terrain only knows about units standing on it
+    float ground;
+    if (!GetGroundHeight(srcX, srcY, ground) || fabs(srcZ - ground) > PATH_MAX_GROUND_DIST)
+        return false;
+    if (!GetGroundHeight(destX, destY, ground) || fabs(destZ - ground) > PATH_MAX_GROUND_DIST)
+        return false;
+
+    float srcCX = ToCellCoord(srcX);
+    float srcCY = ToCellCoord(srcY);
+    float destCX = ToCellCoord(destX);
+    float destCY = ToCellCoord(destY);
+
+    if (IsLineWalkable(srcCX, srcCY, destCX, destCY))
+        return false;
+
+    uint32 startCell = MakeCell(int32(srcCX), int32(srcCY));
+    uint32 endCell = MakeCell(int32(destCX), int32(destCY));
+    uint64 key = (uint64(startCell) << 32) | endCell;
+
+    PointPath corners;
+    CachedPathMap::iterator itr = m_cacheMap.find(key);
+    if (itr != m_cacheMap.end())
+    {
+        ++m_cacheHits;
+        m_cacheList.splice(m_cacheList.begin(), m_cacheList, itr->second);
+        corners = itr->second->points;
+    }
+    else
+    {
+        ++m_cacheMisses;
+        // a failed search is cached too, the unit goes straight as before
+        FindCorners(startCell, endCell, corners);
+
+        if (uint32 cacheSize = sWorld.getConfig(CONFIG_PATHFINDING_CACHE_SIZE))
+        {
+            m_cacheList.push_front(CachedPath());
+            m_cacheList.front().key = key;
+            m_cacheList.front().points = corners;
+            m_cacheMap[key] = m_cacheList.begin();
+
+            while (m_cacheMap.size() > cacheSize)
+            {
+                m_cacheMap.erase(m_cacheList.back().key);
+                m_cacheList.pop_back();
+            }
+        }
+    }
+
+    if (corners.empty())
+        return false;
+
+    path.swap(corners);
+    path.push_back(PathNode(destX, destY, destZ));
+    return true;
+}
+
+bool PathFinder::Refresh(PointPath& path, float destX, float destY, float destZ) const
+{
+    if (path.size() < 2)
+        return false;
+
+    PathNode const& oldEnd = path.back();
+    if (fabs(ToCellCoord(oldEnd.x) - ToCellCoord(destX)) > PATH_REFRESH_CELLS ||
+        fabs(ToCellCoord(oldEnd.y) - ToCellCoord(destY)) > PATH_REFRESH_CELLS)
+        return false;
+
+    float ground;
+    if (!GetGroundHeight(destX, destY, ground) || fabs(destZ - ground) > PATH_MAX_GROUND_DIST)
+        return false;
+
+    // the last corner must still see the new end
+    PathNode const& corner = path[path.size() - 2];
+    if (!IsLineWalkable(ToCellCoord(corner.x), ToCellCoord(corner.y), ToCellCoord(destX), ToCellCoord(destY)))
+        return false;
+
+    path.back() = PathNode(destX, destY, destZ);
+    return true;
+}
+
+bool PathFinder::FindCorners(uint32 startCell, uint32 endCell, PointPath& corners)
+{
+    m_searchNodes.clear();
+    m_openList.clear();
+
+    SearchNode start = { 0, startCell, false };
+    m_searchNodes[startCell] = start;
+    m_openList.push_back(OpenNode(EstimateCost(CellX(startCell), CellY(startCell), endCell), startCell));
+
+    bool found = false;
+    uint32 expanded = 0;
+    while (!m_openList.empty())
+    {
+        std::pop_heap(m_openList.begin(), m_openList.end(), std::greater<OpenNode>());
+        uint32 cell = m_openList.back().second;
+        m_openList.pop_back();
+
+        SearchNode& node = m_searchNodes[cell];
+        if (node.closed)
+            continue;
+        node.closed = true;
+
+        if (cell == endCell)
+        {
+            found = true;
+            break;
+        }
+
+        if (++expanded > PATH_MAX_SEARCH_NODES)
+            break;
+
+        // inserts below may move the node
+        uint32 cost = node.cost;
+        int32 cx = CellX(cell);
+        int32 cy = CellY(cell);
+
+        for (int32 dx = -1; dx <= 1; ++dx)
+        {
+            for (int32 dy = -1; dy <= 1; ++dy)
+            {
+                if (!dx && !dy)
+                    continue;
+
+                int32 nx = cx + dx;
+                int32 ny = cy + dy;
+                uint32 next = MakeCell(nx, ny);
+
+                // the destination may be on a slope, e.g. a target standing at a cliff edge
+                if (next != endCell && !IsWalkable(nx, ny))
+                    continue;
+
+                // no corner cutting
+                if (dx && dy && (!IsWalkable(cx + dx, cy) || !IsWalkable(cx, cy + dy)))
+                    continue;
+
+                uint32 nextCost = cost + (dx && dy ? 14 : 10);
+
+                SearchNodeMap::iterator itr = m_searchNodes.find(next);
+                if (itr == m_searchNodes.end())
+                {
+                    SearchNode nextNode = { nextCost, cell, false };
+                    m_searchNodes[next] = nextNode;
+                }
+                else if (itr->second.closed || itr->second.cost <= nextCost)
+                    continue;
+                else
+                {
+                    itr->second.cost = nextCost;
+                    itr->second.parent = cell;
+                }
+
+                m_openList.push_back(OpenNode(nextCost + EstimateCost(nx, ny, endCell), next));
+                std::push_heap(m_openList.begin(), m_openList.end(), std::greater<OpenNode>());
+            }
+        }
+    }
+
+    if (!found)
+        return false;
+
+    m_cells.clear();
+    for (uint32 cell = endCell; cell != startCell; cell = m_searchNodes[cell].parent)
+        m_cells.push_back(cell);
+    m_cells.push_back(startCell);
+    std::reverse(m_cells.begin(), m_cells.end());
+
+    // keep only the cells where the direction has to change
+    size_t anchor = 0;
+    while (anchor + 1 < m_cells.size())
+    {
+        float fromX = CellX(m_cells[anchor]) + 0.5f;
+        float fromY = CellY(m_cells[anchor]) + 0.5f;
+
+        size_t next = anchor + 1;
+        while (next + 1 < m_cells.size() &&
+            IsLineWalkable(fromX, fromY, CellX(m_cells[next + 1]) + 0.5f, CellY(m_cells[next + 1]) + 0.5f))
+            ++next;
+
+        if (next + 1 < m_cells.size())
+        {
+            float x = FromCellCoord(CellX(m_cells[next]) + 0.5f);
+            float y = FromCellCoord(CellY(m_cells[next]) + 0.5f);
+            float z;
+            if (!GetGroundHeight(x, y, z))
+            {
+                corners.clear();
+                return false;
+            }
+            corners.push_back(PathNode(x, y, z));
+        }
+
+        anchor = next;
+    }
+
+    return true;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MANGOS_PATHFINDER_H
+#define MANGOS_PATHFINDER_H
+
+#include "Common.h"
+#include "Utilities/UnorderedMap.h"
+
+#include <list>
+#include <vector>
+
+class Map;
+class Unit;
+
+struct PathNode
+{
+    PathNode() : x(0), y(0), z(0) {}
+    PathNode(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+
+    float x, y, z;
+};
+
+typedef std::vector<PathNode> PointPath;
+
+// max cells expanded by one search, about 150 yards around the start in open terrain
+#define PATH_MAX_SEARCH_NODES       4096
+// farther above the terrain a unit is in a building or cave, the terrain can't tell about those
+#define PATH_MAX_GROUND_DIST        3.0f
+// a path is kept for a moved destination while it stays this many cells near the old one
+#define PATH_REFRESH_CELLS          2
+
+/**
+ * Terrain paths of one map.
+ *
+ * Walkable cells are taken from the height data of the loaded GridMaps (shared by all
+ * instances of a map). A path is searched with A* over them only when the straight line
+ * crosses unwalkable terrain, and the result is kept in a LRU cache keyed by start and
+ * end cell, so creatures chasing or returning through the same place reuse it.
+ */
+class PathFinder
+{
+    public:
+        explicit PathFinder(Map* map) : m_map(map), m_cacheHits(0), m_cacheMisses(0) {}
+
+        /// Points to walk from the unit position to the destination, the destination itself is the last one.
+        /// Returns false when the unit goes in a straight line (open terrain, flying, indoors, no path, disabled).
+        bool Calculate(Unit const& unit, float destX, float destY, float destZ, PointPath& path);
+        bool Calculate(float srcX, float srcY, float srcZ, float destX, float destY, float destZ, PointPath& path);
+
+        /// Move the end of a path to a destination near the old one without a new search
+        bool Refresh(PointPath& path, float destX, float destY, float destZ) const;
+
+        void GetCacheStats(uint32& size, uint64& hits, uint64& misses) const
+        {
+            size = m_cacheMap.size();
+            hits = m_cacheHits;
+            misses = m_cacheMisses;
+        }
+
+    private:
+        struct CachedPath
+        {
+            uint64 key;
+            PointPath points;                               // corners between start and end, empty for a straight line
+        };
+
+        typedef std::list<CachedPath> CachedPathList;
+        typedef UNORDERED_MAP<uint64, CachedPathList::iterator> CachedPathMap;
+
+        struct SearchNode
+        {
+            uint32 cost;
+            uint32 parent;
+            bool closed;
+        };
+
+        typedef UNORDERED_MAP<uint32, SearchNode> SearchNodeMap;
+        typedef std::pair<uint32, uint32> OpenNode;         // estimated total cost, cell
+        typedef std::vector<OpenNode> OpenList;
+
+        bool IsWalkable(int32 cx, int32 cy) const;
+        bool IsLineWalkable(float fromX, float fromY, float toX, float toY) const;
+        bool GetGroundHeight(float x, float y, float& z) const;
+
+        bool FindCorners(uint32 startCell, uint32 endCell, PointPath& corners);
+
+        Map* m_map;
+
+        // most recently used first
+        CachedPathList m_cacheList;
+        CachedPathMap m_cacheMap;
+        uint64 m_cacheHits;
+        uint64 m_cacheMisses;
+
+        // kept between searches to save allocations
+        SearchNodeMap m_searchNodes;
+        OpenList m_openList;
+        std::vector<uint32> m_cells;
+};
+
+#endif
@@ -355,6 +355,8 @@ Player::Player (WorldSession *session): Unit(), m_achievementMgr(this), m_reputa
     clearResurrectRequestData();
 
     m_SpellModRemoveCount = 0;
+    for (int i = 0; i < MAX_SPELLMOD; ++i)
+        m_spellModChargedCount[i] = 0;
 
     memset(m_items, 0, sizeof(Item*)*PLAYER_SLOTS_COUNT);
 
@@ -6612,6 +6614,9 @@ void Player::_ApplyItemBonuses(ItemPrototype const *proto, uint8 slot, bool appl
     if (only_level_scale && !ssv)
         return;
 
+    // item stats, armor and resistances are recalculated together at ReleaseStatUpdates
+    HoldStatUpdates();
+
     for (int i = 0; i < MAX_ITEM_PROTO_STATS; ++i)
     {
         uint32 statType = 0;
@@ -6875,6 +6880,8 @@ void Player::_ApplyItemBonuses(ItemPrototype const *proto, uint8 slot, bool appl
             ApplyFeralAPBonus(feral_bonus, apply);
     }
 
+    ReleaseStatUpdates();
+
     if(!IsUseEquipedWeapon(slot==EQUIPMENT_SLOT_MAINHAND))
         return;
 
@@ -7274,6 +7281,8 @@ void Player::_RemoveAllItemMods()
         }
     }
 
+    HoldStatUpdates();
+
     for (int i = 0; i < INVENTORY_SLOT_BAG_END; ++i)
     {
         if(m_items[i])
@@ -7295,6 +7304,8 @@ void Player::_RemoveAllItemMods()
         }
     }
 
+    ReleaseStatUpdates();
+
     sLog.outDebug("_RemoveAllItemMods complete.");
 }
 
@@ -7302,6 +7313,8 @@ void Player::_ApplyAllItemMods()
 {
     sLog.outDebug("_ApplyAllItemMods start.");
 
+    HoldStatUpdates();
+
     for (int i = 0; i < INVENTORY_SLOT_BAG_END; ++i)
     {
         if(m_items[i])
@@ -7324,6 +7337,8 @@ void Player::_ApplyAllItemMods()
         }
     }
 
+    ReleaseStatUpdates();
+
     for (int i = 0; i < INVENTORY_SLOT_BAG_END; ++i)
     {
         if(m_items[i])
@@ -17256,15 +17271,58 @@ void Player::AddSpellMod(SpellModifier* mod, bool apply)
         }
     }
 
+    // charges only go down to -1 (expired), never to 0, mod keeps counted until removed
     if (apply)
+    {
         m_spellMods[mod->op].push_back(mod);
+        if (mod->charges)
+            ++m_spellModChargedCount[mod->op];
+    }
     else
     {
         if (mod->charges == -1)
             --m_SpellModRemoveCount;
+        if (mod->charges)
+            --m_spellModChargedCount[mod->op];
         m_spellMods[mod->op].remove(mod);
         delete mod;
     }
+
+    m_spellModCache.clear();
+}
+
+SpellModCacheEntry const& Player::GetSpellModCacheEntry(SpellEntry const* spellInfo, SpellModOp op)
+{
+    uint32 key = spellInfo->Id * MAX_SPELLMOD + op;
+
+    SpellModCache::const_iterator itr = m_spellModCache.find(key);
+    if (itr != m_spellModCache.end())
+        return itr->second;
+
+    SpellModCacheEntry& entry = m_spellModCache[key];
+    entry.flat = 0;
+    entry.pct = 0;
+    entry.pctInstantCast = 0;
+
+    for (SpellModList::const_iterator mItr = m_spellMods[op].begin(); mItr != m_spellMods[op].end(); ++mItr)
+    {
+        SpellModifier *mod = *mItr;
+
+        // without charges IsAffectedBySpellmod is only the family mask check
+        if (mod->charges || !mod->isAffectedOnSpell(spellInfo))
+            continue;
+
+        if (mod->type == SPELLMOD_FLAT)
+            entry.flat += mod->value;
+        else if (mod->type == SPELLMOD_PCT)
+        {
+            entry.pct += mod->value;
+            if (op == SPELLMOD_CASTING_TIME && mod->value <= -100)
+                entry.pctInstantCast += mod->value;
+        }
+    }
+
+    return entry;
 }
 
 void Player::RemoveSpellMods(Spell const* spell)
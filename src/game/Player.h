@@ -121,6 +121,16 @@ struct SpellModifier
 typedef UNORDERED_MAP<uint32, PlayerSpell*> PlayerSpellMap;
 typedef std::list<SpellModifier*> SpellModList;
 
+// Sums of spell modifiers without charges affecting one spell for one SpellModOp
+struct SpellModCacheEntry
+{
+    int32 flat;
+    int32 pct;
+    int32 pctInstantCast;                                   // part of pct from casting time mods <= -100%, not used for casts >= 10 sec
+};
+
+typedef UNORDERED_MAP<uint32, SpellModCacheEntry> SpellModCache;   // key: spellId * MAX_SPELLMOD + op
+
 struct SpellCooldown
 {
     time_t end;
@@ -1626,6 +1636,7 @@ class MANGOS_DLL_SPEC Player : public Unit
         void AddSpellMod(SpellModifier* mod, bool apply);
         bool IsAffectedBySpellmod(SpellEntry const *spellInfo, SpellModifier *mod, Spell const* spell = NULL);
         template <class T> T ApplySpellMod(uint32 spellId, SpellModOp op, T &basevalue, Spell const* spell = NULL);
+        SpellModCacheEntry const& GetSpellModCacheEntry(SpellEntry const* spellInfo, SpellModOp op);
         void RemoveSpellMods(Spell const* spell);
 
         static uint32 const infinityCooldownDelay = MONTH;  // used for set "infinity cooldowns" for spells and check
@@ -1764,6 +1775,7 @@ class MANGOS_DLL_SPEC Player : public Unit
 
         bool UpdateStats(Stats stat);
         bool UpdateAllStats();
+        void UpdateUnitMods(uint32 unitModMask);
         void UpdateResistances(uint32 school);
         void UpdateArmor();
         void UpdateMaxHealth();
@@ -2440,6 +2452,8 @@ class MANGOS_DLL_SPEC Player : public Unit
         float m_armorPenetrationPct;
 
         SpellModList m_spellMods[MAX_SPELLMOD];
+        uint32 m_spellModChargedCount[MAX_SPELLMOD];        // mods with charges in m_spellMods, not cached
+        SpellModCache m_spellModCache;                      // cleared at any m_spellMods change
         int32 m_SpellModRemoveCount;
         EnchantDurationList m_enchantDuration;
         ItemDurationList m_itemDuration;
@@ -2594,12 +2608,29 @@ template <class T> T Player::ApplySpellMod(uint32 spellId, SpellModOp op, T &bas
 {
     SpellEntry const *spellInfo = sSpellStore.LookupEntry(spellId);
     if (!spellInfo) return 0;
+    if (m_spellMods[op].empty()) return 0;
+
+    // mods without charges affect spell same way at each call, use resolved sums
+    SpellModCacheEntry const& cached = GetSpellModCacheEntry(spellInfo, op);
+    int32 totalflat = cached.flat;
     int32 totalpct = 0;
-    int32 totalflat = 0;
-    for (SpellModList::iterator itr = m_spellMods[op].begin(); itr != m_spellMods[op].end(); ++itr)
+    // skip percent mods for null basevalue
+    if (basevalue != T(0))
+    {
+        totalpct = cached.pct;
+        // special case (skip >10sec spell casts for instant cast setting)
+        if (op == SPELLMOD_CASTING_TIME && basevalue >= T(10*IN_MILISECONDS))
+            totalpct -= cached.pctInstantCast;
+    }
+
+    // mods with charges need the check at each call
+    for (SpellModList::iterator itr = m_spellMods[op].begin(); m_spellModChargedCount[op] && itr != m_spellMods[op].end(); ++itr)
     {
         SpellModifier *mod = *itr;
 
+        if (mod->charges == 0)
+            continue;
+
         if(!IsAffectedBySpellmod(spellInfo,mod,spell))
             continue;
         if (mod->type == SPELLMOD_FLAT)
@@ -30,7 +30,12 @@ void PointMovementGenerator<T>::Initialize(T &unit)
     unit.StopMoving();
     unit.addUnitState(UNIT_STAT_ROAMING);
     Traveller<T> traveller(unit);
-    i_destinationHolder.SetDestination(traveller,i_x,i_y,i_z);
+
+    i_pathIndex = 0;
+    if (unit.GetMap()->GetPathFinder().Calculate(unit, i_x, i_y, i_z, i_path))
+        i_destinationHolder.SetDestination(traveller, i_path[0].x, i_path[0].y, i_path[0].z);
+    else
+        i_destinationHolder.SetDestination(traveller,i_x,i_y,i_z);
 
     if (unit.GetTypeId() == TYPEID_UNIT && ((Creature*)&unit)->canFly())
         ((Creature&)unit).AddMonsterMoveFlag(MONSTER_MOVE_FLY);
@@ -51,6 +56,15 @@ bool PointMovementGenerator<T>::Update(T &unit, const uint32 &diff)
 
     if(i_destinationHolder.HasArrived())
     {
+        // reached a corner of the path, go on to the next one
+        if (i_pathIndex + 1 < i_path.size())
+        {
+            i_destinationHolder.UpdateTraveller(traveller, 0, true);
+            ++i_pathIndex;
+            i_destinationHolder.SetDestination(traveller, i_path[i_pathIndex].x, i_path[i_pathIndex].y, i_path[i_pathIndex].z);
+            return true;
+        }
+
         unit.StopMoving();
         MovementInform(unit);
         return false;
@@ -23,6 +23,7 @@
 #include "DestinationHolder.h"
 #include "Traveller.h"
 #include "FollowerReference.h"
+#include "PathFinder.h"
 
 template<class T>
 class MANGOS_DLL_SPEC PointMovementGenerator
@@ -30,7 +31,7 @@ class MANGOS_DLL_SPEC PointMovementGenerator
 {
     public:
         PointMovementGenerator(uint32 _id, float _x, float _y, float _z) : id(_id),
-            i_x(_x), i_y(_y), i_z(_z), i_nextMoveTime(0) {}
+            i_x(_x), i_y(_y), i_z(_z), i_nextMoveTime(0), i_pathIndex(0) {}
 
         void Initialize(T &);
         void Finalize(T &){}
@@ -47,6 +48,10 @@ class MANGOS_DLL_SPEC PointMovementGenerator
         float i_x,i_y,i_z;
         TimeTracker i_nextMoveTime;
         DestinationHolder< Traveller<T> > i_destinationHolder;
+
+        // corners around unwalkable terrain, empty when going straight to the point
+        PointPath i_path;
+        uint32 i_pathIndex;
 };
 
 class MANGOS_DLL_SPEC AssistanceMovementGenerator
@@ -22,16 +22,43 @@
 #include "DestinationHolderImp.h"
 #include "Map.h"
 #include "Util.h"
+#include "Utilities/UnorderedMap.h"
 
-template<>
-void
-RandomMovementGenerator<Creature>::_setRandomLocation(Creature &creature)
+// validated points kept per spawn, more give less repetitive wandering
+#define WANDER_POINTS_PER_SPAWN     10
+// random points tried per spawn before the found ones are used even if less
+#define WANDER_POINT_MAX_TRIES      40
+
+namespace
 {
-    float X,Y,Z,z,nx,ny,nz,wander_distance,ori,dist;
+    struct WanderPoint
+    {
+        WanderPoint(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
 
-    creature.GetRespawnCoord(X, Y, Z, &ori, &wander_distance);
+        float x, y, z;
+    };
+
+    /// Points found around one spawn, shared by all its respawns and by all instances of its map
+    struct WanderPoints
+    {
+        WanderPoints() : x(0.0f), y(0.0f), z(0.0f), dist(0.0f), tries(0) {}
+
+        float x, y, z, dist;                                // spawn point and wander distance the points were made for
+        uint32 tries;
+        std::vector<WanderPoint> points;
+    };
+
+    typedef UNORDERED_MAP<uint32, WanderPoints> WanderPointMap;
+
+    // instances share the spawns of their map, no lock as all maps are updated one by one in MapManager::Update
+    WanderPointMap s_wanderPoints;
+}
 
-    z = creature.GetPositionZ();
+template<>
+bool
+RandomMovementGenerator<Creature>::_findRandomLocation(Creature &creature, float X, float Y, float Z, float wander_distance, float &nx, float &ny, float &nz) const
+{
+    float dist;
     Map const* map = creature.GetBaseMap();
 
     // For 2D/3D system selection
@@ -62,7 +89,7 @@ RandomMovementGenerator<Creature>::_setRandomLocation(Creature &creature)
 
         // Problem here, we must fly above the ground and water, not under. Let's try on next tick
         if (tz >= nz || wz >= nz)
-            return;
+            return false;
     }
     //else if (is_water_ok)                                 // 3D system under water and above ground (swimming mode)
     else                                                    // 2D only
@@ -84,11 +111,71 @@ RandomMovementGenerator<Creature>::_setRandomLocation(Creature &creature)
 
                 // let's forget this bad coords where a z cannot be find and retry at next tick
                 if (fabs(nz-Z) > dist)
-                    return;
+                    return false;
             }
         }
     }
 
+    return true;
+}
+
+template<>
+bool
+RandomMovementGenerator<Creature>::_getRandomLocation(Creature &creature, float &nx, float &ny, float &nz) const
+{
+    float X,Y,Z,wander_distance,ori;
+
+    creature.GetRespawnCoord(X, Y, Z, &ori, &wander_distance);
+
+    // summoned creatures and pets have no spawn to keep points for
+    uint32 guid = creature.GetDBTableGUIDLow();
+    if (!guid)
+        return _findRandomLocation(creature, X, Y, Z, wander_distance, nx, ny, nz);
+
+    WanderPoints& spawn = s_wanderPoints[guid];
+
+    // spawn moved or changed by a GM command
+    if (spawn.x != X || spawn.y != Y || spawn.z != Z || spawn.dist != wander_distance)
+    {
+        spawn.x = X;
+        spawn.y = Y;
+        spawn.z = Z;
+        spawn.dist = wander_distance;
+        spawn.tries = 0;
+        spawn.points.clear();
+    }
+
+    if (spawn.points.size() < WANDER_POINTS_PER_SPAWN && (spawn.tries < WANDER_POINT_MAX_TRIES || spawn.points.empty()))
+    {
+        ++spawn.tries;
+        if (_findRandomLocation(creature, X, Y, Z, wander_distance, nx, ny, nz))
+        {
+            spawn.points.push_back(WanderPoint(nx, ny, nz));
+            return true;
+        }
+
+        // nothing found yet, try again at next move like before
+        if (spawn.points.empty())
+            return false;
+    }
+
+    WanderPoint const& point = spawn.points[urand(0, spawn.points.size() - 1)];
+    nx = point.x;
+    ny = point.y;
+    nz = point.z;
+    return true;
+}
+
+template<>
+void
+RandomMovementGenerator<Creature>::_setRandomLocation(Creature &creature)
+{
+    float nx,ny,nz;
+    if (!_getRandomLocation(creature, nx, ny, nz))
+        return;
+
+    bool is_air_ok = creature.canFly();
+
     Traveller<Creature> traveller(creature);
 
     creature.SetOrientation(creature.GetAngle(nx, ny));
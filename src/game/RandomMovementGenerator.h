@@ -41,6 +41,10 @@ class MANGOS_DLL_SPEC RandomMovementGenerator
         }
         MovementGeneratorType GetMovementGeneratorType() { return RANDOM_MOTION_TYPE; }
     private:
+        // a validated point to wander to, kept per spawn once found
+        bool _getRandomLocation(T &, float &x, float &y, float &z) const;
+        bool _findRandomLocation(T &, float X, float Y, float Z, float wander_distance, float &x, float &y, float &z) const;
+
         TimeTrackerSmall i_nextMoveTime;
 
         DestinationHolder< Traveller<T> > i_destinationHolder;
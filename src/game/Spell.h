@@ -21,6 +21,7 @@
 
 #include "GridDefines.h"
 #include "SharedDefines.h"
+#include "ObjectPool.h"
 
 class WorldSession;
 class Unit;
@@ -331,6 +332,10 @@ class Spell
         Spell( Unit* Caster, SpellEntry const *info, bool triggered, uint64 originalCasterGUID = 0, Spell** triggeringContainer = NULL );
         ~Spell();
 
+        // allocated from ObjectPool
+        static void* operator new(size_t size);
+        static void operator delete(void* p, size_t size);
+
         void prepare(SpellCastTargets const* targets, Aura* triggeredByAura = NULL);
         void cancel();
         void update(uint32 difftime);
@@ -536,7 +541,8 @@ class Spell
             uint8  effectMask:8;
             bool   processed:1;
         };
-        std::list<TargetInfo> m_UniqueTargetInfo;
+        typedef std::list<TargetInfo, ObjectPoolAllocator<TargetInfo> > TargetList;
+        TargetList m_UniqueTargetInfo;
         uint8 m_needAliveTargetMask;                        // Mask req. alive targets
 
         struct GOTargetInfo
@@ -546,14 +552,16 @@ class Spell
             uint8  effectMask:8;
             bool   processed:1;
         };
-        std::list<GOTargetInfo> m_UniqueGOTargetInfo;
+        typedef std::list<GOTargetInfo, ObjectPoolAllocator<GOTargetInfo> > GOTargetList;
+        GOTargetList m_UniqueGOTargetInfo;
 
         struct ItemTargetInfo
         {
             Item  *item;
             uint8 effectMask;
         };
-        std::list<ItemTargetInfo> m_UniqueItemInfo;
+        typedef std::list<ItemTargetInfo, ObjectPoolAllocator<ItemTargetInfo> > ItemTargetList;
+        ItemTargetList m_UniqueItemInfo;
 
         void AddUnitTarget(Unit* target, uint32 effIndex);
         void AddUnitTarget(uint64 unitGUID, uint32 effIndex);
@@ -658,11 +666,17 @@ namespace MaNGOS
 
             for(typename GridRefManager<T>::iterator itr = m.begin(); itr != m.end(); ++itr)
             {
+                // mostly phase check
+                if (!itr->getSource()->IsInMap(i_originalCaster))
+                    continue;
+
+                // visited cells are much larger than most areas, the distance check is cheaper than the ones below
+                if (!IsInPushArea(itr->getSource()))
+                    continue;
+
                 // there are still more spells which can be casted on dead, but
                 // they are no AOE and don't have such a nice SPELL_ATTR flag
-                if ( !itr->getSource()->isTargetableForAttack(i_spell.m_spellInfo->AttributesEx3 & SPELL_ATTR_EX3_CAST_ON_DEAD)
-                    // mostly phase check
-                    || !itr->getSource()->IsInMap(i_originalCaster))
+                if (!itr->getSource()->isTargetableForAttack(i_spell.m_spellInfo->AttributesEx3 & SPELL_ATTR_EX3_CAST_ON_DEAD))
                     continue;
 
                 switch (i_TargetType)
@@ -705,45 +719,35 @@ namespace MaNGOS
                     default: continue;
                 }
 
-                // we don't need to check InMap here, it's already done some lines above
-                switch(i_push_type)
-                {
-                    case PUSH_IN_FRONT:
-                        if(i_spell.GetCaster()->isInFront((Unit*)(itr->getSource()), i_radius, 2*M_PI/3 ))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_IN_FRONT_90:
-                        if(i_spell.GetCaster()->isInFront((Unit*)(itr->getSource()), i_radius, M_PI/2 ))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_IN_FRONT_30:
-                        if(i_spell.GetCaster()->isInFront((Unit*)(itr->getSource()), i_radius, M_PI/6 ))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_IN_FRONT_15:
-                        if(i_spell.GetCaster()->isInFront((Unit*)(itr->getSource()), i_radius, M_PI/12 ))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_IN_BACK:
-                        if(i_spell.GetCaster()->isInBack((Unit*)(itr->getSource()), i_radius, 2*M_PI/3 ))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_SELF_CENTER:
-                        if(i_spell.GetCaster()->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_DEST_CENTER:
-                        if(itr->getSource()->IsWithinDist3d(i_spell.m_targets.m_destX, i_spell.m_targets.m_destY, i_spell.m_targets.m_destZ,i_radius))
-                            i_data->push_back(itr->getSource());
-                        break;
-                    case PUSH_TARGET_CENTER:
-                        if(i_spell.m_targets.getUnitTarget()->IsWithinDist((Unit*)(itr->getSource()), i_radius))
-                            i_data->push_back(itr->getSource());
-                        break;
-                }
+                i_data->push_back(itr->getSource());
             }
         }
 
+        // InMap is checked by the caller
+        bool IsInPushArea(Unit* target) const
+        {
+            switch(i_push_type)
+            {
+                case PUSH_IN_FRONT:
+                    return i_spell.GetCaster()->isInFront(target, i_radius, 2*M_PI/3 );
+                case PUSH_IN_FRONT_90:
+                    return i_spell.GetCaster()->isInFront(target, i_radius, M_PI/2 );
+                case PUSH_IN_FRONT_30:
+                    return i_spell.GetCaster()->isInFront(target, i_radius, M_PI/6 );
+                case PUSH_IN_FRONT_15:
+                    return i_spell.GetCaster()->isInFront(target, i_radius, M_PI/12 );
+                case PUSH_IN_BACK:
+                    return i_spell.GetCaster()->isInBack(target, i_radius, 2*M_PI/3 );
+                case PUSH_SELF_CENTER:
+                    return i_spell.GetCaster()->IsWithinDist(target, i_radius);
+                case PUSH_DEST_CENTER:
+                    return target->IsWithinDist3d(i_spell.m_targets.m_destX, i_spell.m_targets.m_destY, i_spell.m_targets.m_destZ,i_radius);
+                case PUSH_TARGET_CENTER:
+                    return i_spell.m_targets.getUnitTarget()->IsWithinDist(target, i_radius);
+            }
+            return false;
+        }
+
         #ifdef WIN32
         template<> inline void Visit(CorpseMapType & ) {}
         template<> inline void Visit(GameObjectMapType & ) {}
@@ -766,6 +770,10 @@ class SpellEvent : public BasicEvent
         SpellEvent(Spell* spell);
         virtual ~SpellEvent();
 
+        // allocated from ObjectPool
+        static void* operator new(size_t size);
+        static void operator delete(void* p, size_t size);
+
         virtual bool Execute(uint64 e_time, uint32 p_time);
         virtual void Abort(uint64 e_time);
         virtual bool IsDeletable() const;
@@ -45,6 +45,7 @@
 #include "GridNotifiersImpl.h"
 #include "Vehicle.h"
 #include "CellImpl.h"
+#include "ObjectPool.h"
 
 #define NULL_AURA_SLOT 0xFF
 
@@ -373,10 +374,10 @@ static AuraType const frozenAuraTypes[] = { SPELL_AURA_MOD_ROOT, SPELL_AURA_MOD_
 
 Aura::Aura(SpellEntry const* spellproto, uint32 eff, int32 *currentBasePoints, Unit *target, Unit *caster, Item* castItem) :
 m_spellmod(NULL), m_caster_guid(0), m_target(target), m_castItemGuid(castItem?castItem->GetGUID():0),
-m_timeCla(1000), m_periodicTimer(0), m_periodicTick(0), m_removeMode(AURA_REMOVE_BY_DEFAULT), m_AuraDRGroup(DIMINISHING_NONE),
+m_timeCla(1000), m_periodicTimer(0), m_procIndexFlags(0), m_auraTotalsAmount(0), m_periodicTick(0), m_removeMode(AURA_REMOVE_BY_DEFAULT), m_AuraDRGroup(DIMINISHING_NONE),
 m_effIndex(eff), m_auraSlot(MAX_AURAS), m_auraFlags(AFLAG_NONE), m_auraLevel(1), m_procCharges(0), m_stackAmount(1),
 m_positive(false), m_permanent(false), m_isPeriodic(false), m_isAreaAura(false), m_isPersistent(false),
-m_isRemovedOnShapeLost(true), m_in_use(0), m_deleted(false)
+m_isRemovedOnShapeLost(true), m_in_use(0), m_deleted(false), m_inAuraTotals(false)
 {
     assert(target);
 
@@ -479,6 +480,20 @@ m_isRemovedOnShapeLost(true), m_in_use(0), m_deleted(false)
     }
 }
 
+// slot fits all aura classes, never destroyed (auras can be deleted at static objects destruction)
+static size_t const auraSlotSize = std::max(std::max(sizeof(Aura), sizeof(AreaAura)), std::max(sizeof(PersistentAreaAura), sizeof(SingleEnemyTargetAura)));
+static ObjectPool* auraPool = new ObjectPool("Aura", auraSlotSize);
+
+void* Aura::operator new(size_t size)
+{
+    return auraPool->Allocate(size);
+}
+
+void Aura::operator delete(void* p, size_t size)
+{
+    auraPool->Free(p, size);
+}
+
 Aura::~Aura()
 {
 }
@@ -940,7 +955,12 @@ void Aura::ApplyModifier(bool apply, bool Real)
 
     SetInUse(true);
     if(aura < TOTAL_AURAS)
+    {
+        // handlers can change the amount while registered in the aura type list
+        m_target->UpdateAuraTotals(this);
         (*this.*AuraHandler [aura])(apply, Real);
+        m_target->UpdateAuraTotals(this);
+    }
     SetInUse(false);
 }
 
@@ -4922,6 +4942,7 @@ void Aura::HandleAuraModStat(bool apply, bool /*Real*/)
         return;
     }
 
+    m_target->HoldStatUpdates();
     for(int32 i = STAT_STRENGTH; i < MAX_STATS; i++)
     {
         // -1 or -2 is all stats ( misc < -2 checked in function beginning )
@@ -4933,6 +4954,7 @@ void Aura::HandleAuraModStat(bool apply, bool /*Real*/)
                 m_target->ApplyStatBuffMod(Stats(i), m_modifier.m_amount, apply);
         }
     }
+    m_target->ReleaseStatUpdates();
 }
 
 void Aura::HandleModPercentStat(bool apply, bool /*Real*/)
@@ -4947,11 +4969,13 @@ void Aura::HandleModPercentStat(bool apply, bool /*Real*/)
     if (m_target->GetTypeId() != TYPEID_PLAYER)
         return;
 
+    m_target->HoldStatUpdates();
     for (int32 i = STAT_STRENGTH; i < MAX_STATS; ++i)
     {
         if(m_modifier.m_miscvalue == i || m_modifier.m_miscvalue == -1)
             m_target->HandleStatModifier(UnitMods(UNIT_MOD_STAT_START + i), BASE_PCT, float(m_modifier.m_amount), apply);
     }
+    m_target->ReleaseStatUpdates();
 }
 
 void Aura::HandleModSpellDamagePercentFromStat(bool /*apply*/, bool /*Real*/)
@@ -5024,6 +5048,7 @@ void Aura::HandleModTotalPercentStat(bool apply, bool /*Real*/)
     uint32 curHPValue = m_target->GetHealth();
     uint32 maxHPValue = m_target->GetMaxHealth();
 
+    m_target->HoldStatUpdates();
     for (int32 i = STAT_STRENGTH; i < MAX_STATS; i++)
     {
         if(m_modifier.m_miscvalue == i || m_modifier.m_miscvalue == -1)
@@ -5033,6 +5058,7 @@ void Aura::HandleModTotalPercentStat(bool apply, bool /*Real*/)
                 m_target->ApplyStatPercentBuffMod(Stats(i), m_modifier.m_amount, apply );
         }
     }
+    m_target->ReleaseStatUpdates();
 
     //recalculate current HP/MP after applying aura modifications (only for spells with 0x10 flag)
     if ((m_modifier.m_miscvalue == STAT_STAMINA) && (maxHPValue > 0) && (m_spellProto->Attributes & 0x10))
@@ -7135,6 +7161,7 @@ void Aura::PeriodicDummyTick()
                         if ((*i)->GetId() == GetId())
                         {
                             (*i)->GetModifier()->m_amount = m_modifier.m_amount;
+                            m_target->UpdateAuraTotals(*i);
                             ((Player*)m_target)->UpdateManaRegen();
                             // Disable continue
                             m_isPeriodic = false;
@@ -218,6 +218,10 @@ class MANGOS_DLL_SPEC Aura
 
         virtual ~Aura();
 
+        // allocated from ObjectPool, including derived area/persistent auras
+        static void* operator new(size_t size);
+        static void operator delete(void* p, size_t size);
+
         void SetModifier(AuraType t, int32 a, uint32 pt, int32 miscValue);
         Modifier*       GetModifier()       { return &m_modifier; }
         Modifier const* GetModifier() const { return &m_modifier; }
@@ -263,6 +267,14 @@ class MANGOS_DLL_SPEC Aura
         uint8 GetAuraLevel() const { return m_auraLevel; }
         void SetAuraLevel(uint8 level) { m_auraLevel = level; }
         uint8 GetAuraCharges() const { return m_procCharges; }
+        // proc flags the aura is indexed by in Unit::m_procAuras, fixed at apply
+        uint32 GetProcIndexFlags() const { return m_procIndexFlags; }
+        void SetProcIndexFlags(uint32 flags) { m_procIndexFlags = flags; }
+
+        // modifier amount counted in the target's aura totals, see Unit::UpdateAuraTotals
+        bool IsInAuraTotals() const { return m_inAuraTotals; }
+        int32 GetAuraTotalsAmount() const { return m_auraTotalsAmount; }
+        void SetAuraTotalsAmount(bool counted, int32 amount) { m_inAuraTotals = counted; m_auraTotalsAmount = amount; }
         void SetAuraCharges(uint8 charges)
         {
             if (m_procCharges == charges)
@@ -373,6 +385,8 @@ class MANGOS_DLL_SPEC Aura
         int32 m_duration;                                   // Current time
         int32 m_timeCla;                                    // Timer for power per sec calcultion
         int32 m_periodicTimer;                              // Timer for periodic auras
+        uint32 m_procIndexFlags;                            // Proc flags registered in target's proc aura index
+        int32 m_auraTotalsAmount;                           // Modifier amount counted in target's aura totals
         uint32 m_periodicTick;                              // Tick count pass (including current if use in tick code) from aura apply, used for some tick count dependent aura effects
 
         AuraRemoveMode m_removeMode:8;                      // Store info for know remove aura reason
@@ -395,6 +409,7 @@ class MANGOS_DLL_SPEC Aura
         bool m_isRemovedOnShapeLost:1;
         bool m_deleted:1;                                   // true if RemoveAura(iterator) called while in Aura::ApplyModifier call (added to Unit::m_deletedAuras)
         bool m_isSingleTargetAura:1;                        // true if it's a single target spell and registered at caster - can change at spell steal for example
+        bool m_inAuraTotals:1;                              // true while counted in target's aura totals
 
         uint32 m_in_use;                                    // > 0 while in Aura::ApplyModifier call/Aura::Update/etc
     private:
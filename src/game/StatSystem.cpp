@@ -91,6 +91,96 @@ bool Player::UpdateStats(Stats stat)
     return true;
 }
 
+// Batched UpdateStats() for the UnitMods changed while stat updates were held:
+// every dependent value is recalculated once instead of once per changed stat
+void Player::UpdateUnitMods(uint32 unitModMask)
+{
+    // a single changed value gets its usual update
+    if (!(unitModMask & (unitModMask - 1)))
+    {
+        Unit::UpdateUnitMods(unitModMask);
+        return;
+    }
+
+    Pet *pet = GetPet();
+
+    uint32 statMask = 0;
+    for (int i = STAT_STRENGTH; i < MAX_STATS; ++i)
+    {
+        if (!(unitModMask & (1 << (UNIT_MOD_STAT_START + i))))
+            continue;
+
+        SetStat(Stats(i), int32(GetTotalStatValue(Stats(i))));
+        statMask |= (1 << i);
+
+        if (pet && (i == STAT_STAMINA || i == STAT_INTELLECT))
+            pet->UpdateStats(Stats(i));
+    }
+
+    if (statMask & (1 << STAT_STRENGTH))
+        UpdateShieldBlockValue();
+
+    if (statMask & (1 << STAT_AGILITY))
+    {
+        UpdateAllCritPercentages();
+        UpdateDodgePercentage();
+    }
+
+    if (statMask & (1 << STAT_INTELLECT))
+        UpdateAllSpellCritChances();
+
+    if ((statMask & (1 << STAT_STAMINA)) || (unitModMask & (1 << UNIT_MOD_HEALTH)))
+        UpdateMaxHealth();
+
+    for (int i = POWER_MANA; i < MAX_POWERS; ++i)
+        if ((unitModMask & (1 << (UNIT_MOD_POWER_START + i))) || (i == POWER_MANA && (statMask & (1 << STAT_INTELLECT))))
+            UpdateMaxPower(Powers(i));
+
+    for (int i = SPELL_SCHOOL_HOLY; i < MAX_SPELL_SCHOOL; ++i)
+        if (unitModMask & (1 << (UNIT_MOD_RESISTANCE_START + i)))
+            UpdateResistances(i);
+
+    // UpdateArmor() also updates melee attack power, attack power updates include weapon damage
+    bool armor = (statMask & ((1 << STAT_AGILITY) | (1 << STAT_INTELLECT))) || (unitModMask & (1 << UNIT_MOD_ARMOR));
+    bool meleeAP = statMask || (unitModMask & (1 << UNIT_MOD_ATTACK_POWER));
+    bool rangedAP = statMask || (unitModMask & (1 << UNIT_MOD_ATTACK_POWER_RANGED));
+
+    if (armor)
+        UpdateArmor();
+    else if (meleeAP)
+        UpdateAttackPowerAndDamage();
+
+    if (rangedAP)
+        UpdateAttackPowerAndDamage(true);
+
+    bool meleeDamage = armor || meleeAP;
+    if ((unitModMask & (1 << UNIT_MOD_DAMAGE_MAINHAND)) && !meleeDamage)
+        UpdateDamagePhysical(BASE_ATTACK);
+    if ((unitModMask & (1 << UNIT_MOD_DAMAGE_OFFHAND)) && !(meleeDamage && CanDualWield() && haveOffhandWeapon()))
+        UpdateDamagePhysical(OFF_ATTACK);
+    if ((unitModMask & (1 << UNIT_MOD_DAMAGE_RANGED)) && !rangedAP)
+        UpdateDamagePhysical(RANGED_ATTACK);
+
+    if (!statMask)
+        return;
+
+    UpdateSpellDamageAndHealingBonus();
+    UpdateManaRegen();
+
+    // ratings from SPELL_AURA_MOD_RATING_FROM_STAT of any changed stat
+    uint32 mask = 0;
+    AuraList const& modRatingFromStat = GetAurasByType(SPELL_AURA_MOD_RATING_FROM_STAT);
+    for(AuraList::const_iterator i = modRatingFromStat.begin();i != modRatingFromStat.end(); ++i)
+        if ((*i)->GetMiscBValue() < MAX_STATS && (statMask & (1 << (*i)->GetMiscBValue())))
+            mask |= (*i)->GetMiscValue();
+    if (mask)
+    {
+        for (uint32 rating = 0; rating < MAX_COMBAT_RATING; ++rating)
+            if (mask & (1 << rating))
+                ApplyRatingMod(CombatRating(rating), 0, true);
+    }
+}
+
 void Player::ApplySpellPowerBonus(int32 amount, bool apply)
 {
     m_baseSpellPower+=apply?amount:-amount;
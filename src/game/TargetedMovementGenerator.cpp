@@ -82,15 +82,48 @@ TargetedMovementGenerator<T>::_setTargetLocation(T &owner)
             return;
     */
     Traveller<T> traveller(owner);
-    i_destinationHolder.SetDestination(traveller, x, y, z);
+    if (_buildPath(owner, x, y, z))
+        i_destinationHolder.SetDestination(traveller, i_path[i_pathIndex].x, i_path[i_pathIndex].y, i_path[i_pathIndex].z);
+    else
+        i_destinationHolder.SetDestination(traveller, x, y, z);
     owner.addUnitState(UNIT_STAT_CHASE);
     if (owner.GetTypeId() == TYPEID_UNIT && ((Creature*)&owner)->canFly())
         ((Creature&)owner).AddMonsterMoveFlag(MONSTER_MOVE_FLY);
 }
 
+template<class T>
+bool
+TargetedMovementGenerator<T>::_buildPath(T &owner, float x, float y, float z)
+{
+    PathFinder& pathFinder = owner.GetMap()->GetPathFinder();
+
+    // target moved only a bit, keep walking the same corners
+    if (pathFinder.Refresh(i_path, x, y, z))
+        return true;
+
+    i_pathIndex = 0;
+    return pathFinder.Calculate(owner, x, y, z, i_path);
+}
+
+template<class T>
+float
+TargetedMovementGenerator<T>::_getDistanceFromEndSq(Unit const& target) const
+{
+    if (i_path.empty())
+        return i_destinationHolder.GetDistance3dFromDestSq(target);
+
+    PathNode const& end = i_path.back();
+    float dx = target.GetPositionX() - end.x;
+    float dy = target.GetPositionY() - end.y;
+    float dz = target.GetPositionZ() - end.z;
+    return dx*dx + dy*dy + dz*dz;
+}
+
 template<>
 void TargetedMovementGenerator<Creature>::Initialize(Creature &owner)
 {
+    i_path.clear();
+
     if (owner.HasSearchedAssistance())
         owner.AddMonsterMoveFlag(MONSTER_MOVE_WALK);
     else if (owner.isInCombat())
@@ -176,6 +209,15 @@ TargetedMovementGenerator<T>::Update(T &owner, const uint32 & time_diff)
 
     if (i_destinationHolder.UpdateTraveller(traveller, time_diff, false))
     {
+        // reached a corner of the path, go on to the next one
+        if (i_destinationHolder.HasArrived() && i_pathIndex + 1 < i_path.size())
+        {
+            i_destinationHolder.UpdateTraveller(traveller, 0, true);
+            ++i_pathIndex;
+            i_destinationHolder.SetDestination(traveller, i_path[i_pathIndex].x, i_path[i_pathIndex].y, i_path[i_pathIndex].z);
+            return true;
+        }
+
         // put targeted movement generators on a higher priority
         if (owner.GetObjectSize())
             i_destinationHolder.ResetUpdate(50);
@@ -185,7 +227,7 @@ TargetedMovementGenerator<T>::Update(T &owner, const uint32 & time_diff)
         //More distance let have better performance, less distance let have more sensitive reaction at target move.
 
         // try to counter precision differences
-        if (i_destinationHolder.GetDistance3dFromDestSq(*i_target.getTarget()) >= dist * dist)
+        if (_getDistanceFromEndSq(*i_target.getTarget()) >= dist * dist)
         {
             owner.SetInFront(i_target.getTarget());         // Set new Angle For Map::
             _setTargetLocation(owner);                      //Calculate New Dest and Send data To Player
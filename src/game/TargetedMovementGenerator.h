@@ -23,6 +23,7 @@
 #include "DestinationHolder.h"
 #include "Traveller.h"
 #include "FollowerReference.h"
+#include "PathFinder.h"
 
 class MANGOS_DLL_SPEC TargetedMovementGeneratorBase
 {
@@ -40,9 +41,9 @@ class MANGOS_DLL_SPEC TargetedMovementGenerator
     public:
 
         TargetedMovementGenerator(Unit &target)
-            : TargetedMovementGeneratorBase(target), i_offset(0), i_angle(0), i_recalculateTravel(false) {}
+            : TargetedMovementGeneratorBase(target), i_offset(0), i_angle(0), i_recalculateTravel(false), i_pathIndex(0) {}
         TargetedMovementGenerator(Unit &target, float offset, float angle)
-            : TargetedMovementGeneratorBase(target), i_offset(offset), i_angle(angle), i_recalculateTravel(false) {}
+            : TargetedMovementGeneratorBase(target), i_offset(offset), i_angle(angle), i_recalculateTravel(false), i_pathIndex(0) {}
         ~TargetedMovementGenerator() {}
 
         void Initialize(T &);
@@ -66,10 +67,16 @@ class MANGOS_DLL_SPEC TargetedMovementGenerator
     private:
 
         void _setTargetLocation(T &);
+        bool _buildPath(T &, float x, float y, float z);
+        float _getDistanceFromEndSq(Unit const& target) const;
 
         float i_offset;
         float i_angle;
         DestinationHolder< Traveller<T> > i_destinationHolder;
         bool i_recalculateTravel;
+
+        // corners around unwalkable terrain, empty when going straight to the target
+        PointPath i_path;
+        uint32 i_pathIndex;
 };
 #endif
@@ -61,6 +61,8 @@ HostileReference::HostileReference(Unit* pUnit, ThreatManager *pThreatManager, f
     iUnitGuid = pUnit->GetGUID();
     iOnline = true;
     iAccessible = true;
+    iSortPending = false;
+    iSentThreat = 0;
 }
 
 //============================================================
@@ -214,24 +216,56 @@ void ThreatContainer::clearReferences()
         delete (*i);
     }
     iThreatList.clear();
+    iRefsByGuid.clear();
+    iSortPending.clear();
 }
 
 //============================================================
-// Return the HostileReference of NULL, if not found
-HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
+
+void ThreatContainer::addReference(HostileReference* pHostileReference)
 {
-    HostileReference* result = NULL;
-    uint64 guid = pVictim->GetGUID();
-    for(ThreatList::const_iterator i = iThreatList.begin(); i != iThreatList.end(); ++i)
+    // added at the end, placed by the next update()
+    iThreatList.push_back(pHostileReference);
+    iRefsByGuid[pHostileReference->getUnitGuid()] = --iThreatList.end();
+    iAddedSinceSent = true;
+    threatChanged(pHostileReference);
+}
+
+//============================================================
+
+void ThreatContainer::remove(HostileReference* pRef)
+{
+    ThreatRefMap::iterator itr = iRefsByGuid.find(pRef->getUnitGuid());
+    if (itr == iRefsByGuid.end() || *itr->second != pRef)
+        return;
+
+    iThreatList.erase(itr->second);
+    iRefsByGuid.erase(itr);
+
+    if (pRef->iSortPending)
     {
-        if((*i)->getUnitGuid() == guid)
-        {
-            result = (*i);
-            break;
-        }
+        pRef->iSortPending = false;
+        iSortPending.erase(std::find(iSortPending.begin(), iSortPending.end(), pRef));
     }
+}
 
-    return result;
+//============================================================
+
+void ThreatContainer::threatChanged(HostileReference* pRef)
+{
+    if (pRef->iSortPending || iRefsByGuid.find(pRef->getUnitGuid()) == iRefsByGuid.end())
+        return;
+
+    pRef->iSortPending = true;
+    iSortPending.push_back(pRef);
+}
+
+//============================================================
+// Return the HostileReference of NULL, if not found
+HostileReference* ThreatContainer::getReferenceByTarget(Unit* pVictim)
+{
+    ThreatRefMap::const_iterator itr = iRefsByGuid.find(pVictim->GetGUID());
+    return itr != iRefsByGuid.end() ? *itr->second : NULL;
 }
 
 //============================================================
@@ -266,13 +300,65 @@ bool HostileReferenceSortPredicate(const HostileReference* lhs, const HostileRef
 
 void ThreatContainer::update()
 {
-    if(iDirty && iThreatList.size() >1)
+    if (iSortPending.empty() && !iDirty)
+        return;
+
+    // a few changed references are re-inserted into the still sorted rest,
+    // many of them (or an explicit setDirty) get a full sort
+    if (iDirty || iSortPending.size() * 8 > iRefsByGuid.size())
     {
-        iThreatList.sort(HostileReferenceSortPredicate);
+        if (iThreatList.size() > 1)
+            iThreatList.sort(HostileReferenceSortPredicate);
     }
+    else
+    {
+        // splicing keeps the iterators in iRefsByGuid valid
+        ThreatList moved;
+        for (ThreatRefVector::const_iterator itr = iSortPending.begin(); itr != iSortPending.end(); ++itr)
+            moved.splice(moved.end(), iThreatList, iRefsByGuid[(*itr)->getUnitGuid()]);
+
+        while (!moved.empty())
+        {
+            float threat = moved.front()->getThreat();
+            ThreatList::iterator pos = iThreatList.begin();
+            while (pos != iThreatList.end() && (*pos)->getThreat() >= threat)
+                ++pos;
+            iThreatList.splice(pos, moved, moved.begin());
+        }
+    }
+
+    for (ThreatRefVector::const_iterator itr = iSortPending.begin(); itr != iSortPending.end(); ++itr)
+        (*itr)->iSortPending = false;
+    iSortPending.clear();
     iDirty = false;
 }
 
+//============================================================
+// SMSG_THREAT_UPDATE always carries the whole list, so only tell
+// whether it is worth sending at all
+
+bool ThreatContainer::isChangedForClient() const
+{
+    if (iAddedSinceSent)
+        return true;
+
+    for (ThreatList::const_iterator itr = iThreatList.begin(); itr != iThreatList.end(); ++itr)
+        if ((*itr)->iSentThreat != uint32((*itr)->getThreat()))
+            return true;
+
+    return false;
+}
+
+//============================================================
+
+void ThreatContainer::setSentToClient()
+{
+    for (ThreatList::const_iterator itr = iThreatList.begin(); itr != iThreatList.end(); ++itr)
+        (*itr)->iSentThreat = uint32((*itr)->getThreat());
+
+    iAddedSinceSent = false;
+}
+
 //============================================================
 // return the next best victim
 // could be the current victim
@@ -283,6 +369,9 @@ HostileReference* ThreatContainer::selectNextVictim(Creature* pAttacker, Hostile
     bool found = false;
     bool noPriorityTargetFound = false;
 
+    if (iThreatList.empty())
+        return NULL;
+
     ThreatList::const_iterator lastRef = iThreatList.end();
     lastRef--;
 
@@ -352,7 +441,7 @@ HostileReference* ThreatContainer::selectNextVictim(Creature* pAttacker, Hostile
 //============================================================
 
 ThreatManager::ThreatManager(Unit* owner)
-: iCurrentVictim(NULL), iOwner(owner), iUpdateTimer(THREAT_UPDATE_INTERVAL), iUpdateNeed(false)
+: iCurrentVictim(NULL), iOwner(owner), iUpdateTimer(THREAT_UPDATE_INTERVAL), iFullUpdateTimer(THREAT_FULL_UPDATE_INTERVAL), iUpdateNeed(false)
 {
 }
 
@@ -364,6 +453,7 @@ void ThreatManager::clearReferences()
     iThreatOfflineContainer.clearReferences();
     iCurrentVictim = NULL;
     iUpdateTimer.Reset(THREAT_UPDATE_INTERVAL);
+    iFullUpdateTimer.Reset(THREAT_FULL_UPDATE_INTERVAL);
     iUpdateNeed = false;
 }
 
@@ -481,7 +571,10 @@ void ThreatManager::setCurrentVictim(HostileReference* pHostileReference)
         return;
 
     if (pHostileReference)
+    {
         iOwner->SendHighestThreatUpdate(pHostileReference);
+        iThreatContainer.setSentToClient();
+    }
 
     iCurrentVictim = pHostileReference;
     iUpdateNeed = true;
@@ -500,18 +593,17 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
     switch(threatRefStatusChangeEvent->getType())
     {
         case UEV_THREAT_REF_THREAT_CHANGE:
-            if((getCurrentVictim() == hostileReference && threatRefStatusChangeEvent->getFValue()<0.0f) ||
-                (getCurrentVictim() != hostileReference && threatRefStatusChangeEvent->getFValue()>0.0f))
-                setDirty(true);                             // the order in the threat list might have changed
+            // the order in the threat list might have changed
+            if (hostileReference->isOnline())
+                iThreatContainer.threatChanged(hostileReference);
+            else
+                iThreatOfflineContainer.threatChanged(hostileReference);
             break;
         case UEV_THREAT_REF_ONLINE_STATUS:
             if(!hostileReference->isOnline())
             {
                 if (hostileReference == getCurrentVictim())
-                {
                     setCurrentVictim(NULL);
-                    setDirty(true);
-                }
                 iOwner->SendThreatRemove(hostileReference);
                 iThreatContainer.remove(hostileReference);
                 iUpdateNeed = true;
@@ -519,19 +611,14 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
             }
             else
             {
-                if(getCurrentVictim() && hostileReference->getThreat() > (1.1f * getCurrentVictim()->getThreat()))
-                    setDirty(true);
+                iThreatOfflineContainer.remove(hostileReference);
                 iThreatContainer.addReference(hostileReference);
                 iUpdateNeed = true;
-                iThreatOfflineContainer.remove(hostileReference);
             }
             break;
         case UEV_THREAT_REF_REMOVE_FROM_LIST:
             if (hostileReference == getCurrentVictim())
-            {
                 setCurrentVictim(NULL);
-                setDirty(true);
-            }
             if(hostileReference->isOnline())
             {
                 iOwner->SendThreatRemove(hostileReference);
@@ -546,13 +633,24 @@ void ThreatManager::processThreatEvent(ThreatRefStatusChangeEvent* threatRefStat
 
 void ThreatManager::UpdateForClient(uint32 diff)
 {
-    if (!iUpdateNeed || isThreatListEmpty())
+    if (isThreatListEmpty())
+        return;
+
+    iFullUpdateTimer.Update(diff);
+    if (!iUpdateNeed && !iFullUpdateTimer.Passed())
         return;
 
     iUpdateTimer.Update(diff);
     if (iUpdateTimer.Passed())
     {
-        iOwner->SendThreatUpdate();
+        // removals are sent at once, skip the update when no value visible to the client changed
+        // but resend the list from time to time, players that see the owner only now have none
+        if (iThreatContainer.isChangedForClient() || iFullUpdateTimer.Passed())
+        {
+            iOwner->SendThreatUpdate();
+            iThreatContainer.setSentToClient();
+            iFullUpdateTimer.Reset(THREAT_FULL_UPDATE_INTERVAL);
+        }
         iUpdateTimer.Reset(THREAT_UPDATE_INTERVAL);
         iUpdateNeed = false;
     }
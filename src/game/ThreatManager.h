@@ -24,7 +24,9 @@
 #include "Utilities/LinkedReference/Reference.h"
 #include "UnitEvents.h"
 #include "Timer.h"
+#include "Utilities/UnorderedMap.h"
 #include <list>
+#include <vector>
 
 //==============================================================
 
@@ -34,6 +36,7 @@ class ThreatManager;
 struct SpellEntry;
 
 #define THREAT_UPDATE_INTERVAL 1 * IN_MILISECONDS    // Server should send threat update to client periodically each second
+#define THREAT_FULL_UPDATE_INTERVAL 5 * IN_MILISECONDS  // Unchanged threat list is still resent, for players that started to see the owner
 
 //==============================================================
 // Class to calculate the real threat based
@@ -114,6 +117,8 @@ class MANGOS_DLL_SPEC HostileReference : public Reference<Unit, ThreatManager>
         // Tell our refFrom (source) object, that the link is cut (Target destroyed)
         void sourceObjectDestroyLink();
     private:
+        friend class ThreatContainer;
+
         // Inform the source, that the status of that reference was changed
         void fireStatusChanged(ThreatRefStatusChangeEvent& pThreatRefStatusChangeEvent);
 
@@ -124,6 +129,8 @@ class MANGOS_DLL_SPEC HostileReference : public Reference<Unit, ThreatManager>
         uint64 iUnitGuid;
         bool iOnline;
         bool iAccessible;
+        bool iSortPending;                                  // queued for re-placing in the threat list
+        uint32 iSentThreat;                                 // threat value last sent to clients
 };
 
 //==============================================================
@@ -132,21 +139,34 @@ class ThreatManager;
 typedef std::list<HostileReference*> ThreatList;
 
 
+// The list stays a std::list: AI code iterates it while changing threat (and so adding
+// or moving references), so it is only reordered in update() and only by splicing.
 class MANGOS_DLL_SPEC ThreatContainer
 {
     private:
+        typedef UNORDERED_MAP<uint64, ThreatList::iterator> ThreatRefMap;
+        typedef std::vector<HostileReference*> ThreatRefVector;
+
         ThreatList iThreatList;
-        bool iDirty;
+        ThreatRefMap iRefsByGuid;                           // position of each reference in iThreatList
+        ThreatRefVector iSortPending;                       // references with changed threat since last update()
+        bool iDirty;                                        // full sort requested
+        bool iAddedSinceSent;                               // references not yet sent to clients
     protected:
         friend class ThreatManager;
 
-        void remove(HostileReference* pRef) { iThreatList.remove(pRef); }
-        void addReference(HostileReference* pHostileReference) { iThreatList.push_back(pHostileReference); }
+        void remove(HostileReference* pRef);
+        void addReference(HostileReference* pHostileReference);
         void clearReferences();
+        // Queue the reference for re-placing at the next update()
+        void threatChanged(HostileReference* pRef);
         // Sort the list if necessary
         void update();
+        // Client threat list differs from the current values
+        bool isChangedForClient() const;
+        void setSentToClient();
     public:
-        ThreatContainer() { iDirty = false; }
+        ThreatContainer() { iDirty = false; iAddedSinceSent = false; }
         ~ThreatContainer() { clearReferences(); }
 
         HostileReference* addThreat(Unit* pVictim, float pThreat);
@@ -212,6 +232,7 @@ class MANGOS_DLL_SPEC ThreatManager
         HostileReference* iCurrentVictim;
         Unit* iOwner;
         TimeTrackerSmall iUpdateTimer;
+        TimeTrackerSmall iFullUpdateTimer;
         bool iUpdateNeed;
         ThreatContainer iThreatContainer;
         ThreatContainer iThreatOfflineContainer;
@@ -52,7 +52,8 @@ struct MANGOS_DLL_DECL Traveller
     float GetMoveDestinationTo(float x, float y, float z);
     uint32 GetTotalTrevelTimeTo(float x, float y, float z);
 
-    void Relocation(float x, float y, float z, float orientation) {}
+    // lazyNotify: position inside a movement, nearby units need to know only after some distance
+    void Relocation(float x, float y, float z, float orientation, bool lazyNotify = false) {}
     void Relocation(float x, float y, float z) { Relocation(x, y, z, i_traveller.GetOrientation()); }
     void MoveTo(float x, float y, float z, uint32 t) {}
 };
@@ -80,9 +81,9 @@ inline float Traveller<Creature>::Speed()
 }
 
 template<>
-inline void Traveller<Creature>::Relocation(float x, float y, float z, float orientation)
+inline void Traveller<Creature>::Relocation(float x, float y, float z, float orientation, bool lazyNotify)
 {
-    i_traveller.GetMap()->CreatureRelocation(&i_traveller, x, y, z, orientation);
+    i_traveller.GetMap()->CreatureRelocation(&i_traveller, x, y, z, orientation, lazyNotify);
 }
 
 template<>
@@ -129,9 +130,10 @@ inline float Traveller<Player>::GetMoveDestinationTo(float x, float y, float z)
 }
 
 template<>
-inline void Traveller<Player>::Relocation(float x, float y, float z, float orientation)
+inline void Traveller<Player>::Relocation(float x, float y, float z, float orientation, bool lazyNotify)
 {
-    i_traveller.GetMap()->PlayerRelocation(&i_traveller, x, y, z, orientation);
+    // only taxi flights follow a fixed path, other player movement generators may change direction at any time
+    i_traveller.GetMap()->PlayerRelocation(&i_traveller, x, y, z, orientation, lazyNotify && i_traveller.isInFlight());
 }
 
 template<>
@@ -71,6 +71,23 @@ static bool isNonTriggerAura[TOTAL_AURAS];
 // Prepare lists
 static bool procPrepared = InitTriggerAuraData();
 
+// Proc flags the aura can be triggered by, 0 if it never procs (same selection as in Unit::IsTriggeredAtSpellProcEvent)
+static uint32 GetAuraEventProcFlags(Aura* aura)
+{
+    uint32 auraName = aura->GetModifier()->m_auraname;
+    if (auraName >= TOTAL_AURAS || isNonTriggerAura[auraName])
+        return 0;
+
+    SpellProcEventEntry const* spellProcEvent = sSpellMgr.GetSpellProcEvent(aura->GetId());
+    if (!isTriggerAura[auraName] && spellProcEvent == NULL)
+        return 0;
+
+    if (spellProcEvent && spellProcEvent->procFlags)
+        return spellProcEvent->procFlags;
+
+    return aura->GetSpellProto()->procFlags;
+}
+
 Unit::Unit()
 : WorldObject(), i_motionMaster(this), m_ThreatManager(this), m_HostileRefManager(this)
 {
@@ -105,6 +122,9 @@ Unit::Unit()
     //m_AurasCheck = 2000;
     //m_removeAuraTimer = 4;
     m_AurasUpdateIterator = m_Auras.end();
+
+    for (int i = 0; i < TOTAL_AURAS; ++i)
+        m_auraTotals[i] = NULL;
     m_AuraFlags = 0;
 
     m_Visibility = VISIBILITY_ON;
@@ -114,6 +134,8 @@ Unit::Unit()
     m_transform = 0;
     m_ShapeShiftFormSpellId = 0;
     m_canModifyStats = false;
+    m_statUpdateHold = 0;
+    m_dirtyUnitMods = 0;
 
     for (int i = 0; i < MAX_SPELL_IMMUNITY; ++i)
         m_spellImmune[i].clear();
@@ -173,6 +195,9 @@ Unit::~Unit()
     if (m_charmInfo)
         delete m_charmInfo;
 
+    for (int i = 0; i < TOTAL_AURAS; ++i)
+        delete m_auraTotals[i];
+
     // those should be already removed at "RemoveFromWorld()" call
     assert(m_gameObj.size() == 0);
     assert(m_dynObjGUIDs.size() == 0);
@@ -1961,6 +1986,7 @@ void Unit::CalcAbsorbResist(Unit *pVictim,SpellSchoolMask schoolMask, DamageEffe
         mod->m_amount-=currentAbsorb;
         if((*i)->DropAuraCharge())
             mod->m_amount = 0;
+        pVictim->UpdateAuraTotals(*i);
         // Need remove it later
         if (mod->m_amount<=0)
             existExpired = true;
@@ -2015,6 +2041,7 @@ void Unit::CalcAbsorbResist(Unit *pVictim,SpellSchoolMask schoolMask, DamageEffe
         }
 
         (*i)->GetModifier()->m_amount -= currentAbsorb;
+        pVictim->UpdateAuraTotals(*i);
         if((*i)->GetModifier()->m_amount <= 0)
         {
             pVictim->RemoveAurasDueToSpell((*i)->GetId());
@@ -3108,27 +3135,17 @@ void Unit::_UpdateSpells( uint32 time )
         }
     }
 
-    // update auras
+    // update auras and remove expired ones in same pass
     // m_AurasUpdateIterator can be updated in inderect called code at aura remove to skip next planned to update but removed auras
     for (m_AurasUpdateIterator = m_Auras.begin(); m_AurasUpdateIterator != m_Auras.end();)
     {
         Aura* i_aura = m_AurasUpdateIterator->second;
         ++m_AurasUpdateIterator;                            // need shift to next for allow update if need into aura update
         i_aura->UpdateAura(time);
-    }
 
-    // remove expired auras
-    for (AuraMap::iterator i = m_Auras.begin(); i != m_Auras.end();)
-    {
-        if ((*i).second)
-        {
-            if ( !(*i).second->GetAuraDuration() && !((*i).second->IsPermanent() || ((*i).second->IsPassive())) )
-                RemoveAura(i);
-            else
-                ++i;
-        }
-        else
-            ++i;
+        // aura in use can't be deleted by own update, but its iterator can be invalidated, so remove by pointer
+        if (!i_aura->GetAuraDuration() && !(i_aura->IsPermanent() || i_aura->IsPassive()))
+            RemoveAura(i_aura);
     }
 
     if(!m_gameObj.empty())
@@ -3381,50 +3398,196 @@ void Unit::DeMorph()
     SetDisplayId(GetNativeDisplayId());
 }
 
-int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+static inline void CountAuraAmount(AuraModifierTotals& totals, int32 amount, bool sum, bool extrema)
 {
-    int32 modifier = 0;
+    if (sum)
+        totals.total += amount;
+    if (extrema)
+        totals.AddExtrema(amount);
+}
 
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        modifier += (*i)->GetModifier()->m_amount;
+void AuraTypeTotals::Count(int32 amount, int32 miscValue, bool sum, bool extrema)
+{
+    CountAuraAmount(all, amount, sum, extrema);
 
-    return modifier;
+    if (!buckets)
+        return;
+
+    for(int j = 0; j < MAX_AURA_TOTALS_BUCKETS; ++j)
+        if (miscValue & (1 << j))
+            CountAuraAmount(buckets[j], amount, sum, extrema);
+
+    if (miscValue >= 0 && miscValue < MAX_AURA_TOTALS_BUCKETS)
+        CountAuraAmount(buckets[MAX_AURA_TOTALS_BUCKETS + miscValue], amount, sum, extrema);
 }
 
-float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+void AuraTypeTotals::Add(int32 amount, int32 miscValue)
 {
-    float multiplier = 1.0f;
+    Count(amount, miscValue, true, extremaValid);
+}
 
-    AuraList const& mTotalAuraList = GetAurasByType(auratype);
-    for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        multiplier *= (100.0f + (*i)->GetModifier()->m_amount)/100.0f;
+void AuraTypeTotals::Remove(int32 amount, int32 miscValue)
+{
+    // amount 0 doesn't change multiplier and max values
+    if (!amount)
+        return;
 
-    return multiplier;
+    Count(-amount, miscValue, true, false);
+    extremaValid = false;
 }
 
-int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+void Unit::AddAuraToTotals(Aura* aura)
 {
-    int32 modifier = 0;
+    Modifier const* mod = aura->GetModifier();
+
+    AuraTypeTotals*& totals = m_auraTotals[mod->m_auraname];
+    if (!totals)
+        totals = new AuraTypeTotals;
+
+    totals->Add(mod->m_amount, mod->m_miscvalue);
+    aura->SetAuraTotalsAmount(true, mod->m_amount);
+}
 
+void Unit::RemoveAuraFromTotals(Aura* aura)
+{
+    if (!aura->IsInAuraTotals())
+        return;
+
+    Modifier const* mod = aura->GetModifier();
+    m_auraTotals[mod->m_auraname]->Remove(aura->GetAuraTotalsAmount(), mod->m_miscvalue);
+    aura->SetAuraTotalsAmount(false, 0);
+}
+
+void Unit::UpdateAuraTotals(Aura* aura)
+{
+    Modifier const* mod = aura->GetModifier();
+    if (!aura->IsInAuraTotals() || mod->m_amount == aura->GetAuraTotalsAmount())
+        return;
+
+    AuraTypeTotals* totals = m_auraTotals[mod->m_auraname];
+    totals->Remove(aura->GetAuraTotalsAmount(), mod->m_miscvalue);
+    totals->Add(mod->m_amount, mod->m_miscvalue);
+    aura->SetAuraTotalsAmount(true, mod->m_amount);
+}
+
+void Unit::RebuildAuraTotals(AuraType auratype, bool extremaOnly) const
+{
+    AuraTypeTotals& totals = *m_auraTotals[auratype];
+
+    if (extremaOnly)
+        totals.all.ResetExtrema();
+    else
+        totals.all.Reset();
+
+    if (totals.buckets)
+    {
+        for(int i = 0; i < MAX_AURA_TOTALS_BUCKETS * 2; ++i)
+        {
+            if (extremaOnly)
+                totals.buckets[i].ResetExtrema();
+            else
+                totals.buckets[i].Reset();
+        }
+    }
+
+    // counted amounts, they differ from the real ones only if an UpdateAuraTotals call is missing
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount > modifier)
-            modifier = (*i)->GetModifier()->m_amount;
+        totals.Count((*i)->GetAuraTotalsAmount(), (*i)->GetModifier()->m_miscvalue, !extremaOnly, true);
 
-    return modifier;
+    totals.extremaValid = true;
 }
 
-int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
+// totals of aura types never applied to the unit
+static AuraModifierTotals const s_noAuraTotals = { 0, 1.0f, 0, 0 };
+
+AuraModifierTotals const& Unit::GetAuraTotals(AuraType auratype, bool extrema) const
 {
-    int32 modifier = 0;
+    AuraTypeTotals* totals = m_auraTotals[auratype];
+    if (!totals)
+        return s_noAuraTotals;
+
+    if (extrema && !totals->extremaValid)
+        RebuildAuraTotals(auratype, true);
+#ifdef MANGOS_DEBUG
+    // catch modifier changes that were not followed by UpdateAuraTotals
+    AuraModifierTotals check;
+    check.Reset();
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
     for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
-        if ((*i)->GetModifier()->m_amount < modifier)
-            modifier = (*i)->GetModifier()->m_amount;
+        CountAuraAmount(check, (*i)->GetModifier()->m_amount, true, true);
 
-    return modifier;
+    if (check.total != totals->all.total ||
+        (totals->extremaValid && (check.maxPositive != totals->all.maxPositive || check.maxNegative != totals->all.maxNegative)))
+    {
+        sLog.outError("Unit::GetAuraTotals: stale totals for aura type %u at unit %u (counted %i, real %i)", auratype, GetGUIDLow(), totals->all.total, check.total);
+        for(AuraList::const_iterator i = mTotalAuraList.begin();i != mTotalAuraList.end(); ++i)
+            const_cast<Unit*>(this)->UpdateAuraTotals(*i);
+        if (extrema && !totals->extremaValid)
+            RebuildAuraTotals(auratype, true);
+    }
+#endif
+    return totals->all;
+}
+
+AuraModifierTotals const* Unit::GetAuraTotalsBucket(AuraType auratype, uint32 bucket, bool extrema) const
+{
+    AuraTypeTotals* totals = m_auraTotals[auratype];
+    if (!totals)
+        return &s_noAuraTotals;
+
+    // first query by misc value of the type, count the applied auras once, updated with the others after
+    if (!totals->buckets)
+    {
+        totals->buckets = new AuraModifierTotals[MAX_AURA_TOTALS_BUCKETS * 2];
+        RebuildAuraTotals(auratype, false);
+    }
+    else if (extrema && !totals->extremaValid)
+        RebuildAuraTotals(auratype, true);
+
+    return &totals->buckets[bucket];
+}
+
+AuraModifierTotals const* Unit::GetAuraTotalsByMiscMask(AuraType auratype, uint32 misc_mask, bool extrema) const
+{
+    // only single bit masks (one school in most cases) have own bucket, other need full list check
+    if (misc_mask & (misc_mask - 1) || misc_mask >= (1 << MAX_AURA_TOTALS_BUCKETS))
+        return NULL;
+
+    uint32 bit = 0;
+    while (!(misc_mask & (1 << bit)))
+        ++bit;
+
+    return GetAuraTotalsBucket(auratype, bit, extrema);
+}
+
+AuraModifierTotals const* Unit::GetAuraTotalsByMiscValue(AuraType auratype, int32 misc_value, bool extrema) const
+{
+    if (misc_value < 0 || misc_value >= MAX_AURA_TOTALS_BUCKETS)
+        return NULL;
+
+    return GetAuraTotalsBucket(auratype, MAX_AURA_TOTALS_BUCKETS + misc_value, extrema);
+}
+
+int32 Unit::GetTotalAuraModifier(AuraType auratype) const
+{
+    return GetAuraTotals(auratype, false).total;
+}
+
+float Unit::GetTotalAuraMultiplier(AuraType auratype) const
+{
+    return GetAuraTotals(auratype, true).multiplier;
+}
+
+int32 Unit::GetMaxPositiveAuraModifier(AuraType auratype) const
+{
+    return GetAuraTotals(auratype, true).maxPositive;
+}
+
+int32 Unit::GetMaxNegativeAuraModifier(AuraType auratype) const
+{
+    return GetAuraTotals(auratype, true).maxNegative;
 }
 
 int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask) const
@@ -3432,6 +3595,9 @@ int32 Unit::GetTotalAuraModifierByMiscMask(AuraType auratype, uint32 misc_mask)
     if(!misc_mask)
         return 0;
 
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscMask(auratype, misc_mask, false))
+        return totals->total;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3449,6 +3615,9 @@ float Unit::GetTotalAuraMultiplierByMiscMask(AuraType auratype, uint32 misc_mask
     if(!misc_mask)
         return 1.0f;
 
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscMask(auratype, misc_mask, true))
+        return totals->multiplier;
+
     float multiplier = 1.0f;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3466,6 +3635,9 @@ int32 Unit::GetMaxPositiveAuraModifierByMiscMask(AuraType auratype, uint32 misc_
     if(!misc_mask)
         return 0;
 
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscMask(auratype, misc_mask, true))
+        return totals->maxPositive;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3484,6 +3656,9 @@ int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_
     if(!misc_mask)
         return 0;
 
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscMask(auratype, misc_mask, true))
+        return totals->maxNegative;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3499,6 +3674,9 @@ int32 Unit::GetMaxNegativeAuraModifierByMiscMask(AuraType auratype, uint32 misc_
 
 int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscValue(auratype, misc_value, false))
+        return totals->total;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3513,6 +3691,9 @@ int32 Unit::GetTotalAuraModifierByMiscValue(AuraType auratype, int32 misc_value)
 
 float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscValue(auratype, misc_value, true))
+        return totals->multiplier;
+
     float multiplier = 1.0f;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3527,6 +3708,9 @@ float Unit::GetTotalAuraMultiplierByMiscValue(AuraType auratype, int32 misc_valu
 
 int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscValue(auratype, misc_value, true))
+        return totals->maxPositive;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3542,6 +3726,9 @@ int32 Unit::GetMaxPositiveAuraModifierByMiscValue(AuraType auratype, int32 misc_
 
 int32 Unit::GetMaxNegativeAuraModifierByMiscValue(AuraType auratype, int32 misc_value) const
 {
+    if (AuraModifierTotals const* totals = GetAuraTotalsByMiscValue(auratype, misc_value, true))
+        return totals->maxNegative;
+
     int32 modifier = 0;
 
     AuraList const& mTotalAuraList = GetAurasByType(auratype);
@@ -3717,8 +3904,15 @@ bool Unit::AddAura(Aura *Aur)
     if (aurName < TOTAL_AURAS)
     {
         m_modAuras[aurName].push_back(Aur);
+        AddAuraToTotals(Aur);
     }
 
+    // index by proc flags, ProcDamageAndSpellFor only looks at auras that can proc from the event
+    Aur->SetProcIndexFlags(GetAuraEventProcFlags(Aur) & ((1 << MAX_PROC_FLAG_BITS) - 1));
+    for (uint32 i = 0; i < MAX_PROC_FLAG_BITS; ++i)
+        if (Aur->GetProcIndexFlags() & (1 << i))
+            m_procAuras[i].push_back(Aur);
+
     Aur->ApplyModifier(true,true);
     sLog.outDebug("Aura %u now is in use", aurName);
 
@@ -4249,8 +4443,13 @@ void Unit::RemoveAura(AuraMap::iterator &i, AuraRemoveMode mode)
     if (Aur->GetModifier()->m_auraname < TOTAL_AURAS)
     {
         m_modAuras[Aur->GetModifier()->m_auraname].remove(Aur);
+        RemoveAuraFromTotals(Aur);
     }
 
+    for (uint32 i = 0; i < MAX_PROC_FLAG_BITS; ++i)
+        if (Aur->GetProcIndexFlags() & (1 << i))
+            m_procAuras[i].remove(Aur);
+
     // Set remove mode
     Aur->SetRemoveMode(mode);
 
@@ -5334,6 +5533,7 @@ bool Unit::HandleDummyAuraProc(Unit *pVictim, uint32 damage, Aura* triggeredByAu
                 if (procEx & PROC_EX_CRITICAL_HIT)
                 {
                     mod->m_amount *=2;
+                    UpdateAuraTotals(counter);
                     if (mod->m_amount < 100) // not enough
                         return true;
                     // Crititcal counted -> roll chance
@@ -5341,6 +5541,7 @@ bool Unit::HandleDummyAuraProc(Unit *pVictim, uint32 damage, Aura* triggeredByAu
                        CastSpell(this, 48108, true, castItem, triggeredByAura);
                 }
                 mod->m_amount = 25;
+                UpdateAuraTotals(counter);
                 return true;
             }
             // Burnout
@@ -5505,6 +5706,7 @@ bool Unit::HandleDummyAuraProc(Unit *pVictim, uint32 damage, Aura* triggeredByAu
 
                 // Damage counting
                 mod->m_amount-=damage;
+                UpdateAuraTotals(triggeredByAura);
                 return true;
             }
             // Seed of Corruption (Mobs cast) - no die req
@@ -5526,6 +5728,7 @@ bool Unit::HandleDummyAuraProc(Unit *pVictim, uint32 damage, Aura* triggeredByAu
                 }
                 // Damage counting
                 mod->m_amount-=damage;
+                UpdateAuraTotals(triggeredByAura);
                 return true;
             }
             // Fel Synergy
@@ -11122,44 +11325,75 @@ bool Unit::HandleStatModifier(UnitMods unitMod, UnitModifierType modifierType, f
     if(!CanModifyStats())
         return false;
 
-    switch(unitMod)
+    if (m_statUpdateHold)
+        m_dirtyUnitMods |= (1 << unitMod);
+    else
+        UpdateUnitMods(1 << unitMod);
+
+    return true;
+}
+
+void Unit::ReleaseStatUpdates()
+{
+    ASSERT(m_statUpdateHold);
+
+    if (--m_statUpdateHold || !m_dirtyUnitMods)
+        return;
+
+    uint32 unitModMask = m_dirtyUnitMods;
+    m_dirtyUnitMods = 0;
+
+    // stats disabled meanwhile, UpdateAllStats() is expected when enabled again
+    if (CanModifyStats())
+        UpdateUnitMods(unitModMask);
+}
+
+void Unit::UpdateUnitMods(uint32 unitModMask)
+{
+    for (int i = 0; i < UNIT_MOD_END; ++i)
     {
-        case UNIT_MOD_STAT_STRENGTH:
-        case UNIT_MOD_STAT_AGILITY:
-        case UNIT_MOD_STAT_STAMINA:
-        case UNIT_MOD_STAT_INTELLECT:
-        case UNIT_MOD_STAT_SPIRIT:         UpdateStats(GetStatByAuraGroup(unitMod));  break;
-
-        case UNIT_MOD_ARMOR:               UpdateArmor();           break;
-        case UNIT_MOD_HEALTH:              UpdateMaxHealth();       break;
-
-        case UNIT_MOD_MANA:
-        case UNIT_MOD_RAGE:
-        case UNIT_MOD_FOCUS:
-        case UNIT_MOD_ENERGY:
-        case UNIT_MOD_HAPPINESS:
-        case UNIT_MOD_RUNE:
-        case UNIT_MOD_RUNIC_POWER:          UpdateMaxPower(GetPowerTypeByAuraGroup(unitMod));          break;
-
-        case UNIT_MOD_RESISTANCE_HOLY:
-        case UNIT_MOD_RESISTANCE_FIRE:
-        case UNIT_MOD_RESISTANCE_NATURE:
-        case UNIT_MOD_RESISTANCE_FROST:
-        case UNIT_MOD_RESISTANCE_SHADOW:
-        case UNIT_MOD_RESISTANCE_ARCANE:   UpdateResistances(GetSpellSchoolByAuraGroup(unitMod));      break;
-
-        case UNIT_MOD_ATTACK_POWER:        UpdateAttackPowerAndDamage();         break;
-        case UNIT_MOD_ATTACK_POWER_RANGED: UpdateAttackPowerAndDamage(true);     break;
-
-        case UNIT_MOD_DAMAGE_MAINHAND:     UpdateDamagePhysical(BASE_ATTACK);    break;
-        case UNIT_MOD_DAMAGE_OFFHAND:      UpdateDamagePhysical(OFF_ATTACK);     break;
-        case UNIT_MOD_DAMAGE_RANGED:       UpdateDamagePhysical(RANGED_ATTACK);  break;
+        if (!(unitModMask & (1 << i)))
+            continue;
 
-        default:
-            break;
-    }
+        UnitMods unitMod = UnitMods(i);
 
-    return true;
+        switch(unitMod)
+        {
+            case UNIT_MOD_STAT_STRENGTH:
+            case UNIT_MOD_STAT_AGILITY:
+            case UNIT_MOD_STAT_STAMINA:
+            case UNIT_MOD_STAT_INTELLECT:
+            case UNIT_MOD_STAT_SPIRIT:         UpdateStats(GetStatByAuraGroup(unitMod));  break;
+
+            case UNIT_MOD_ARMOR:               UpdateArmor();           break;
+            case UNIT_MOD_HEALTH:              UpdateMaxHealth();       break;
+
+            case UNIT_MOD_MANA:
+            case UNIT_MOD_RAGE:
+            case UNIT_MOD_FOCUS:
+            case UNIT_MOD_ENERGY:
+            case UNIT_MOD_HAPPINESS:
+            case UNIT_MOD_RUNE:
+            case UNIT_MOD_RUNIC_POWER:          UpdateMaxPower(GetPowerTypeByAuraGroup(unitMod));          break;
+
+            case UNIT_MOD_RESISTANCE_HOLY:
+            case UNIT_MOD_RESISTANCE_FIRE:
+            case UNIT_MOD_RESISTANCE_NATURE:
+            case UNIT_MOD_RESISTANCE_FROST:
+            case UNIT_MOD_RESISTANCE_SHADOW:
+            case UNIT_MOD_RESISTANCE_ARCANE:   UpdateResistances(GetSpellSchoolByAuraGroup(unitMod));      break;
+
+            case UNIT_MOD_ATTACK_POWER:        UpdateAttackPowerAndDamage();         break;
+            case UNIT_MOD_ATTACK_POWER_RANGED: UpdateAttackPowerAndDamage(true);     break;
+
+            case UNIT_MOD_DAMAGE_MAINHAND:     UpdateDamagePhysical(BASE_ATTACK);    break;
+            case UNIT_MOD_DAMAGE_OFFHAND:      UpdateDamagePhysical(OFF_ATTACK);     break;
+            case UNIT_MOD_DAMAGE_RANGED:       UpdateDamagePhysical(RANGED_ATTACK);  break;
+
+            default:
+                break;
+        }
+    }
 }
 
 float Unit::GetModifierValue(UnitMods unitMod, UnitModifierType modifierType) const
@@ -11760,6 +11994,14 @@ struct ProcTriggeredData
 
 typedef std::list< ProcTriggeredData > ProcTriggeredList;
 typedef std::list< uint32> RemoveSpellList;
+typedef std::vector< Aura* > ProcCandidateList;
+
+static bool ProcCandidateOrder(Aura* a, Aura* b)
+{
+    if (a->GetId() != b->GetId())
+        return a->GetId() < b->GetId();
+    return a->GetEffIndex() < b->GetEffIndex();
+}
 
 // List of auras that CAN be trigger but may not exist in spell_proc_event
 // in most case need for drop charges
@@ -11918,19 +12160,50 @@ void Unit::ProcDamageAndSpellFor( bool isVictim, Unit * pTarget, uint32 procFlag
 
     RemoveSpellList removedSpells;
     ProcTriggeredList procTriggered;
+    // Collect candidates from the proc flag index, only auras sharing a flag with the event can proc
+    ProcCandidateList candidates;
+    uint32 seenFlags = 0;
+    for (uint32 i = 0; i < MAX_PROC_FLAG_BITS; ++i)
+    {
+        uint32 flag = 1 << i;
+        if (!(procFlag & flag))
+            continue;
+
+        for (AuraList::const_iterator itr = m_procAuras[i].begin(); itr != m_procAuras[i].end(); ++itr)
+        {
+            // already taken from the list of a lower flag
+            if ((*itr)->GetProcIndexFlags() & seenFlags)
+                continue;
+
+            candidates.push_back(*itr);
+        }
+
+        seenFlags |= flag;
+    }
+
+    // Nothing can proc
+    if (candidates.empty())
+        return;
+
+    // Keep the m_Auras order, it decides which aura uses shared charges/cooldowns first
+    if (candidates.size() > 1)
+        std::stable_sort(candidates.begin(), candidates.end(), ProcCandidateOrder);
+
     // Fill procTriggered list
-    for(AuraMap::const_iterator itr = GetAuras().begin(); itr!= GetAuras().end(); ++itr)
+    for(ProcCandidateList::const_iterator itr = candidates.begin(); itr != candidates.end(); ++itr)
     {
+        Aura* aura = *itr;
+
         // skip deleted auras (possible at recursive triggered call
-        if(itr->second->IsDeleted())
+        if(aura->IsDeleted())
             continue;
 
         SpellProcEventEntry const* spellProcEvent = NULL;
-        if(!IsTriggeredAtSpellProcEvent(pTarget, itr->second, procSpell, procFlag, procExtra, attType, isVictim, (damage > 0), spellProcEvent))
+        if(!IsTriggeredAtSpellProcEvent(pTarget, aura, procSpell, procFlag, procExtra, attType, isVictim, (damage > 0), spellProcEvent))
            continue;
 
-        itr->second->SetInUse(true);                        // prevent aura deletion
-        procTriggered.push_back( ProcTriggeredData(spellProcEvent, itr->second) );
+        aura->SetInUse(true);                               // prevent aura deletion
+        procTriggered.push_back( ProcTriggeredData(spellProcEvent, aura) );
     }
 
     // Nothing found
@@ -12489,17 +12762,7 @@ Unit* Unit::SelectNearbyTarget(Unit* except /*= NULL*/) const
         targets.remove(except);
 
     // remove not LoS targets
-    for(std::list<Unit *>::iterator tIter = targets.begin(); tIter != targets.end();)
-    {
-        if(!IsWithinLOSInMap(*tIter))
-        {
-            std::list<Unit *>::iterator tIter2 = tIter;
-            ++tIter;
-            targets.erase(tIter2);
-        }
-        else
-            ++tIter;
-    }
+    RemoveNotWithinLOSInMap(targets);
 
     // no appropriate targets
     if(targets.empty())
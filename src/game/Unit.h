@@ -117,6 +117,8 @@ enum SpellModOp
 
 #define MAX_SPELLMOD 32
 
+#define MAX_PROC_FLAG_BITS 24                               // count of ProcFlags bits (see SpellMgr.h)
+
 enum SpellFacingFlags
 {
     SPELL_FACING_FLAG_INFRONT = 0x0001
@@ -712,6 +714,52 @@ struct SpellPeriodicAuraLogInfo
 
 uint32 createProcExtendMask(SpellNonMeleeDamage *damageInfo, SpellMissInfo missCondition);
 
+// Aggregated modifier amounts of a set of auras, see Unit::GetTotalAuraModifier and co
+struct AuraModifierTotals
+{
+    void Reset() { total = 0; ResetExtrema(); }
+    void ResetExtrema() { multiplier = 1.0f; maxPositive = 0; maxNegative = 0; }
+
+    void AddExtrema(int32 amount)
+    {
+        multiplier *= (100.0f + amount)/100.0f;
+        if (amount > maxPositive)
+            maxPositive = amount;
+        if (amount < maxNegative)
+            maxNegative = amount;
+    }
+
+    int32 total;
+    float multiplier;
+    int32 maxPositive;
+    int32 maxNegative;
+};
+
+// misc mask bits and misc values below this have own buckets in the aura totals
+#define MAX_AURA_TOTALS_BUCKETS 8
+
+// Totals of one aura type, updated at aura apply, remove and amount change.
+// Sums are always exact, multiplier and max values can't be subtracted and
+// are rebuilt from the aura list at first use after a remove or change.
+struct AuraTypeTotals
+{
+    AuraTypeTotals() : buckets(NULL), extremaValid(true) { all.Reset(); }
+    ~AuraTypeTotals() { delete[] buckets; }
+
+    void Add(int32 amount, int32 miscValue);
+    void Remove(int32 amount, int32 miscValue);
+    // add amount to the sums and/or the multiplier and max values of all and the matching buckets
+    void Count(int32 amount, int32 miscValue, bool sum, bool extrema);
+
+    AuraModifierTotals all;
+    AuraModifierTotals* buckets;                            // [bit] by misc mask bit, [MAX_AURA_TOTALS_BUCKETS + value] by misc value, allocated at first such query
+    bool extremaValid;
+
+    private:
+        AuraTypeTotals(AuraTypeTotals const&);
+        AuraTypeTotals& operator=(AuraTypeTotals const&);
+};
+
 #define MAX_DECLINED_NAME_CASES 5
 
 struct DeclinedName
@@ -1353,6 +1401,11 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         Powers GetPowerTypeByAuraGroup(UnitMods unitMod) const;
         bool CanModifyStats() const { return m_canModifyStats; }
         void SetCanModifyStats(bool modifyStats) { m_canModifyStats = modifyStats; }
+        // while held HandleStatModifier only marks the changed UnitMods, the last
+        // ReleaseStatUpdates() recalculates them and their dependent values once
+        void HoldStatUpdates() { ++m_statUpdateHold; }
+        void ReleaseStatUpdates();
+        virtual void UpdateUnitMods(uint32 unitModMask);
         virtual bool UpdateStats(Stats stat) = 0;
         virtual bool UpdateAllStats() = 0;
         virtual void UpdateResistances(uint32 school) = 0;
@@ -1444,6 +1497,9 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         // misc have plain value but we check it fit to provided values mask (mask & (1 << (misc-1)))
         float GetTotalAuraMultiplierByMiscValueForMask(AuraType auratype, uint32 mask) const;
 
+        // must be called when modifier amount of an aura in GetAurasByType() lists changed outside Aura::ApplyModifier
+        void UpdateAuraTotals(Aura* aura);
+
         Aura* GetDummyAura(uint32 spell_id) const;
 
         uint32 m_AuraFlags;
@@ -1605,9 +1661,13 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
         uint32 m_transform;
 
         AuraList m_modAuras[TOTAL_AURAS];
+        AuraList m_procAuras[MAX_PROC_FLAG_BITS];          // auras able to proc, by PROC_FLAG_* bit
+        AuraTypeTotals* m_auraTotals[TOTAL_AURAS];          // aggregates of m_modAuras lists, allocated at first aura of the type
         float m_auraModifiersGroup[UNIT_MOD_END][MODIFIER_TYPE_END];
         float m_weaponDamage[MAX_ATTACK][2];
         bool m_canModifyStats;
+        uint32 m_statUpdateHold;
+        uint32 m_dirtyUnitMods;                             // 1 << UnitMods changed while stat updates are held
         //std::list< spellEffectPair > AuraSpells[TOTAL_AURAS];  // TODO: use this if ok for mem
         VisibleAuraMap m_visibleAuras;
 
@@ -1626,6 +1686,15 @@ class MANGOS_DLL_SPEC Unit : public WorldObject
     private:
         void CleanupDeletedAuras();
 
+        void AddAuraToTotals(Aura* aura);
+        void RemoveAuraFromTotals(Aura* aura);
+        // extrema: multiplier and max values are needed, not only the sum
+        AuraModifierTotals const& GetAuraTotals(AuraType auratype, bool extrema) const;
+        AuraModifierTotals const* GetAuraTotalsBucket(AuraType auratype, uint32 bucket, bool extrema) const;
+        AuraModifierTotals const* GetAuraTotalsByMiscMask(AuraType auratype, uint32 misc_mask, bool extrema) const;
+        AuraModifierTotals const* GetAuraTotalsByMiscValue(AuraType auratype, int32 misc_value, bool extrema) const;
+        void RebuildAuraTotals(AuraType auratype, bool extremaOnly) const;
+
         bool IsTriggeredAtSpellProcEvent(Unit *pVictim, Aura* aura, SpellEntry const* procSpell, uint32 procFlag, uint32 procExtra, WeaponAttackType attType, bool isVictim, bool active, SpellProcEventEntry const*& spellProcEvent );
         bool HandleDummyAuraProc(   Unit *pVictim, uint32 damage, Aura* triggredByAura, SpellEntry const *procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
         bool HandleHasteAuraProc(   Unit *pVictim, uint32 damage, Aura* triggredByAura, SpellEntry const *procSpell, uint32 procFlag, uint32 procEx, uint32 cooldown);
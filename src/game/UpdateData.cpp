@@ -25,18 +25,20 @@
 #include "World.h"
 #include <zlib/zlib.h>
 
+#include <algorithm>
+
 UpdateData::UpdateData() : m_blockCount(0)
 {
 }
 
 void UpdateData::AddOutOfRangeGUID(std::set<uint64>& guids)
 {
-    m_outOfRangeGUIDs.insert(guids.begin(),guids.end());
+    m_outOfRangeGUIDs.insert(m_outOfRangeGUIDs.end(), guids.begin(), guids.end());
 }
 
 void UpdateData::AddOutOfRangeGUID(const uint64 &guid)
 {
-    m_outOfRangeGUIDs.insert(guid);
+    m_outOfRangeGUIDs.push_back(guid);
 }
 
 void UpdateData::AddUpdateBlock(const ByteBuffer &block)
@@ -105,6 +107,9 @@ bool UpdateData::BuildPacket(WorldPacket *packet)
 {
     ASSERT(packet->empty());                                // shouldn't happen
 
+    std::sort(m_outOfRangeGUIDs.begin(), m_outOfRangeGUIDs.end());
+    m_outOfRangeGUIDs.erase(std::unique(m_outOfRangeGUIDs.begin(), m_outOfRangeGUIDs.end()), m_outOfRangeGUIDs.end());
+
     ByteBuffer buf(4 + (m_outOfRangeGUIDs.empty() ? 0 : 1 + 4 + 9 * m_outOfRangeGUIDs.size()) + m_data.wpos());
 
     buf << (uint32) (!m_outOfRangeGUIDs.empty() ? m_blockCount + 1 : m_blockCount);
@@ -114,7 +119,7 @@ bool UpdateData::BuildPacket(WorldPacket *packet)
         buf << (uint8) UPDATETYPE_OUT_OF_RANGE_OBJECTS;
         buf << (uint32) m_outOfRangeGUIDs.size();
 
-        for(std::set<uint64>::const_iterator i = m_outOfRangeGUIDs.begin(); i != m_outOfRangeGUIDs.end(); ++i)
+        for(GuidList::const_iterator i = m_outOfRangeGUIDs.begin(); i != m_outOfRangeGUIDs.end(); ++i)
         {
             buf.appendPackGUID(*i);
         }
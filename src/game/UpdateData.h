@@ -52,20 +52,26 @@ enum OBJECT_UPDATE_FLAGS
 class UpdateData
 {
     public:
+        typedef std::vector<uint64> GuidList;
+
         UpdateData();
 
         void AddOutOfRangeGUID(std::set<uint64>& guids);
         void AddOutOfRangeGUID(const uint64 &guid);
         void AddUpdateBlock(const ByteBuffer &block);
+        /// Buffer to write a new block to, directly behind the previous ones
+        ByteBuffer& AddUpdateBlock() { ++m_blockCount; return m_data; }
         bool BuildPacket(WorldPacket *packet);
         bool HasData() { return m_blockCount > 0 || !m_outOfRangeGUIDs.empty(); }
+        /// Keeps the allocated memory for reuse
         void Clear();
 
-        std::set<uint64> const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
+        /// Each guid once, after BuildPacket()
+        GuidList const& GetOutOfRangeGUIDs() const { return m_outOfRangeGUIDs; }
 
     protected:
         uint32 m_blockCount;
-        std::set<uint64> m_outOfRangeGUIDs;
+        GuidList m_outOfRangeGUIDs;                         // may contain a guid more than once until BuildPacket()
         ByteBuffer m_data;
 
         void Compress(void* dst, uint32 *dst_size, void* src, int src_size);
@@ -22,17 +22,13 @@
 #include "UpdateFields.h"
 #include "Errors.h"
 
+// blocks for the largest object, masks never allocate
+#define UPDATE_MASK_MAX_BLOCKS ((PLAYER_END + 31) / 32)
+
 class UpdateMask
 {
     public:
-        UpdateMask( ) : mCount( 0 ), mBlocks( 0 ), mUpdateMask( 0 ) { }
-        UpdateMask( const UpdateMask& mask ) : mUpdateMask( 0 ) { *this = mask; }
-
-        ~UpdateMask( )
-        {
-            if(mUpdateMask)
-                delete [] mUpdateMask;
-        }
+        UpdateMask( ) : mCount( 0 ), mBlocks( 0 ) { }
 
         void SetBit (uint32 index)
         {
@@ -49,6 +45,24 @@ class UpdateMask
             return ( ( (uint8 *)mUpdateMask)[ index >> 3 ] & ( 1 << ( index & 0x7 ) )) != 0;
         }
 
+        // first set bit at index or after it, GetCount() if there is none
+        uint32 GetNextSetBit(uint32 index) const
+        {
+            for (; index < mCount; ++index)
+            {
+                // skip empty blocks at once
+                if (!(index & 0x1F) && !mUpdateMask[index >> 5])
+                {
+                    index += 0x1F;
+                    continue;
+                }
+
+                if (GetBit(index))
+                    return index;
+            }
+            return mCount;
+        }
+
         uint32 GetBlockCount() const { return mBlocks; }
         uint32 GetLength() const { return mBlocks << 2; }
         uint32 GetCount() const { return mCount; }
@@ -56,25 +70,23 @@ class UpdateMask
 
         void SetCount (uint32 valuesCount)
         {
-            if(mUpdateMask)
-                delete [] mUpdateMask;
+            ASSERT(valuesCount <= PLAYER_END);
 
             mCount = valuesCount;
             mBlocks = (valuesCount + 31) / 32;
 
-            mUpdateMask = new uint32[mBlocks];
             memset(mUpdateMask, 0, mBlocks << 2);
         }
 
         void Clear()
         {
-            if (mUpdateMask)
-                memset(mUpdateMask, 0, mBlocks << 2);
+            memset(mUpdateMask, 0, mBlocks << 2);
         }
 
         UpdateMask& operator = ( const UpdateMask& mask )
         {
-            SetCount(mask.mCount);
+            mCount = mask.mCount;
+            mBlocks = mask.mBlocks;
             memcpy(mUpdateMask, mask.mUpdateMask, mBlocks << 2);
 
             return *this;
@@ -119,6 +131,6 @@ class UpdateMask
     private:
         uint32 mCount;
         uint32 mBlocks;
-        uint32 *mUpdateMask;
+        uint32 mUpdateMask[UPDATE_MASK_MAX_BLOCKS];
 };
 #endif
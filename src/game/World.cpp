@@ -62,6 +62,7 @@
 #include "WaypointManager.h"
 #include "GMTicketMgr.h"
 #include "Util.h"
+#include "OpcodeStats.h"
 
 INSTANTIATE_SINGLETON_1( World );
 
@@ -558,6 +559,8 @@ void World::LoadConfigSettings(bool reload)
     }
     m_configs[CONFIG_ADDON_CHANNEL] = sConfig.GetBoolDefault("AddonChannel", true);
     m_configs[CONFIG_GRID_UNLOAD] = sConfig.GetBoolDefault("GridUnload", true);
+    m_configs[CONFIG_GRID_UNLOAD_HYSTERESIS] = sConfig.GetIntDefault("GridUnload.Hysteresis", 15 * MINUTE);
+    m_configs[CONFIG_GRID_TERRAIN_CACHE] = sConfig.GetIntDefault("GridUnload.TerrainCache", 64);
     m_configs[CONFIG_INTERVAL_SAVE] = sConfig.GetIntDefault("PlayerSaveInterval", 15 * MINUTE * IN_MILISECONDS);
 
     m_configs[CONFIG_INTERVAL_GRIDCLEAN] = sConfig.GetIntDefault("GridCleanUpDelay", 5 * MINUTE * IN_MILISECONDS);
@@ -842,6 +845,14 @@ void World::LoadConfigSettings(bool reload)
         m_timers[WUPDATE_UPTIME].Reset();
     }
 
+    m_configs[CONFIG_OPCODE_STATS_LOG_INTERVAL] = sConfig.GetIntDefault("OpcodeStatsLogInterval", 0);
+    m_configs[CONFIG_OPCODE_STATS_HANDLER_TIME] = sConfig.GetBoolDefault("OpcodeStatsHandlerTime", true);
+    if(reload)
+    {
+        m_timers[WUPDATE_OPCODESTATS].SetInterval(m_configs[CONFIG_OPCODE_STATS_LOG_INTERVAL]*MINUTE*IN_MILISECONDS);
+        m_timers[WUPDATE_OPCODESTATS].Reset();
+    }
+
     m_configs[CONFIG_SKILL_CHANCE_ORANGE] = sConfig.GetIntDefault("SkillChance.Orange",100);
     m_configs[CONFIG_SKILL_CHANCE_YELLOW] = sConfig.GetIntDefault("SkillChance.Yellow",75);
     m_configs[CONFIG_SKILL_CHANCE_GREEN]  = sConfig.GetIntDefault("SkillChance.Green",25);
@@ -931,6 +942,9 @@ void World::LoadConfigSettings(bool reload)
 
     m_configs[CONFIG_DETECT_POS_COLLISION] = sConfig.GetBoolDefault("DetectPosCollision", true);
 
+    m_configs[CONFIG_PATHFINDING]            = sConfig.GetBoolDefault("Pathfinding.Enable", true);
+    m_configs[CONFIG_PATHFINDING_CACHE_SIZE] = sConfig.GetIntDefault("Pathfinding.CacheSize", 256);
+
     m_configs[CONFIG_RESTRICTED_LFG_CHANNEL]      = sConfig.GetBoolDefault("Channel.RestrictedLfg", true);
     m_configs[CONFIG_SILENTLY_GM_JOIN_TO_CHANNEL] = sConfig.GetBoolDefault("Channel.SilentlyGMJoin", false);
 
@@ -1095,13 +1109,15 @@ void World::LoadConfigSettings(bool reload)
     bool enableHeight = sConfig.GetBoolDefault("vmap.enableHeight", false);
     std::string ignoreMapIds = sConfig.GetStringDefault("vmap.ignoreMapIds", "");
     std::string ignoreSpellIds = sConfig.GetStringDefault("vmap.ignoreSpellIds", "");
+    uint32 losCacheTime = sConfig.GetIntDefault("vmap.losCacheTime", 500);
     VMAP::VMapFactory::createOrGetVMapManager()->setEnableLineOfSightCalc(enableLOS);
     VMAP::VMapFactory::createOrGetVMapManager()->setEnableHeightCalc(enableHeight);
     VMAP::VMapFactory::createOrGetVMapManager()->preventMapsFromBeingUsed(ignoreMapIds.c_str());
+    VMAP::VMapFactory::createOrGetVMapManager()->setLineOfSightCacheTime(losCacheTime);
     VMAP::VMapFactory::preventSpellsFromBeingTestedForLoS(ignoreSpellIds.c_str());
-    sLog.outString( "WORLD: VMap support included. LineOfSight:%i, getHeight:%i",enableLOS, enableHeight);
+    sLog.outString( "WORLD: VMap support included. LineOfSight:%i, getHeight:%i, LoS cache time:%u ms",enableLOS, enableHeight, losCacheTime);
     sLog.outString( "WORLD: VMap data directory is: %svmaps",m_dataPath.c_str());
-    sLog.outString( "WORLD: VMap config keys are: vmap.enableLOS, vmap.enableHeight, vmap.ignoreMapIds, vmap.ignoreSpellIds");
+    sLog.outString( "WORLD: VMap config keys are: vmap.enableLOS, vmap.enableHeight, vmap.ignoreMapIds, vmap.ignoreSpellIds, vmap.losCacheTime");
 }
 
 /// Initialize the World
@@ -1486,6 +1502,7 @@ void World::SetInitialWorldSettings()
                                                             //Update "uptime" table based on configuration entry in minutes.
     m_timers[WUPDATE_CORPSES].SetInterval(20*MINUTE*IN_MILISECONDS);
                                                             //erase corpses every 20 minutes
+    m_timers[WUPDATE_OPCODESTATS].SetInterval(m_configs[CONFIG_OPCODE_STATS_LOG_INTERVAL]*MINUTE*IN_MILISECONDS);
 
     //to set mailtimer to return mails every day between 4 and 5 am
     //mailtimer is increased when updating auctions
@@ -1651,6 +1668,16 @@ void World::Update(uint32 diff)
         loginDatabase.PExecute("UPDATE uptime SET uptime = %u, maxplayers = %u WHERE realmid = %u AND starttime = " UI64FMTD, tmpDiff, maxClientsNum, realmID, uint64(m_startTime));
     }
 
+    /// <li> Dump opcode statistics to the log, if enabled
+    if (m_configs[CONFIG_OPCODE_STATS_LOG_INTERVAL] && m_timers[WUPDATE_OPCODESTATS].Passed())
+    {
+        m_timers[WUPDATE_OPCODESTATS].Reset();
+        sOpcodeStats.LogReport(10);
+    }
+
+    ///- Expire cached line of sight results and free vmap data replaced by loads, no map is updated meanwhile
+    VMAP::VMapFactory::createOrGetVMapManager()->update(diff);
+
     /// <li> Handle all other objects
     if (m_timers[WUPDATE_OBJECTS].Passed())
     {
@@ -2064,10 +2091,13 @@ void World::UpdateSessions( uint32 diff )
         next = itr;
         ++next;
         ///- and remove not active sessions from the list
-        if(!itr->second->Update(diff))                      // As interval = 0
+        WorldSession* pSession = itr->second;
+        WorldSessionFilter updater(pSession);
+
+        if(!pSession->Update(diff, updater))                // As interval = 0
         {
-            RemoveQueuedPlayer (itr->second);
-            delete itr->second;
+            RemoveQueuedPlayer (pSession);
+            delete pSession;
             m_sessions.erase(itr);
         }
     }
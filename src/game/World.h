@@ -77,7 +77,8 @@ enum WorldTimers
     WUPDATE_UPTIME      = 4,
     WUPDATE_CORPSES     = 5,
     WUPDATE_EVENTS      = 6,
-    WUPDATE_COUNT       = 7
+    WUPDATE_OPCODESTATS = 7,
+    WUPDATE_COUNT       = 8
 };
 
 /// Configuration elements
@@ -85,6 +86,8 @@ enum WorldConfigs
 {
     CONFIG_COMPRESSION = 0,
     CONFIG_GRID_UNLOAD,
+    CONFIG_GRID_UNLOAD_HYSTERESIS,
+    CONFIG_GRID_TERRAIN_CACHE,
     CONFIG_INTERVAL_SAVE,
     CONFIG_INTERVAL_GRIDCLEAN,
     CONFIG_INTERVAL_MAPUPDATE,
@@ -146,6 +149,8 @@ enum WorldConfigs
     CONFIG_GROUP_VISIBILITY,
     CONFIG_MAIL_DELIVERY_DELAY,
     CONFIG_UPTIME_UPDATE,
+    CONFIG_OPCODE_STATS_LOG_INTERVAL,
+    CONFIG_OPCODE_STATS_HANDLER_TIME,
     CONFIG_SKILL_CHANCE_ORANGE,
     CONFIG_SKILL_CHANCE_YELLOW,
     CONFIG_SKILL_CHANCE_GREEN,
@@ -174,6 +179,8 @@ enum WorldConfigs
     CONFIG_QUEST_LOW_LEVEL_HIDE_DIFF,
     CONFIG_QUEST_HIGH_LEVEL_HIDE_DIFF,
     CONFIG_DETECT_POS_COLLISION,
+    CONFIG_PATHFINDING,
+    CONFIG_PATHFINDING_CACHE_SIZE,
     CONFIG_RESTRICTED_LFG_CHANNEL,
     CONFIG_SILENTLY_GM_JOIN_TO_CHANNEL,
     CONFIG_TALENTS_INSPECTING,
@@ -378,6 +385,8 @@ class World
     public:
         static volatile uint32 m_worldLoopCounter;
 
+        typedef UNORDERED_MAP<uint32, WorldSession*> SessionMap;
+
         World();
         ~World();
 
@@ -389,6 +398,8 @@ class World
         uint32 GetActiveAndQueuedSessionCount() const { return m_sessions.size(); }
         uint32 GetActiveSessionCount() const { return m_sessions.size() - m_QueuedPlayer.size(); }
         uint32 GetQueuedSessionCount() const { return m_QueuedPlayer.size(); }
+        /// All sessions, active and queued (world thread only)
+        SessionMap const& GetAllSessions() const { return m_sessions; }
         /// Get the maximum number of parallel sessions on the server since last reboot
         uint32 GetMaxQueuedSessionCount() const { return m_maxQueuedSessionCount; }
         uint32 GetMaxActiveSessionCount() const { return m_maxActiveSessionCount; }
@@ -554,7 +565,6 @@ class World
 
         typedef UNORDERED_MAP<uint32, Weather*> WeatherMap;
         WeatherMap m_weathers;
-        typedef UNORDERED_MAP<uint32, WorldSession*> SessionMap;
         SessionMap m_sessions;
         uint32 m_maxActiveSessionCount;
         uint32 m_maxQueuedSessionCount;
@@ -35,6 +35,7 @@
 #include "BattleGroundMgr.h"
 #include "MapManager.h"
 #include "SocialMgr.h"
+#include "OpcodeStats.h"
 #include "zlib/zlib.h"
 
 /// WorldSession constructor
@@ -43,7 +44,8 @@ LookingForGroup_auto_join(false), LookingForGroup_auto_add(false), m_muteTime(mu
 _player(NULL), m_Socket(sock),_security(sec), _accountId(id), m_expansion(expansion),
 m_sessionDbcLocale(sWorld.GetAvailableDbcLocale(locale)), m_sessionDbLocaleIndex(sObjectMgr.GetIndexForLocale(locale)),
 _logoutTime(0), m_inQueue(false), m_playerLoading(false), m_playerLogout(false), m_playerRecentlyLogout(false), m_playerSave(false),
-m_latency(0), m_TutorialsChanged(false)
+m_latency(0), m_TutorialsChanged(false), _recvQueue(WORLD_SESSION_RECV_QUEUE_SIZE),
+m_statPackets(0), m_statBytes(0), m_statHandlerTime(0)
 {
     if (sock)
     {
@@ -91,50 +93,14 @@ void WorldSession::SendPacket(WorldPacket const* packet)
     if (!m_Socket)
         return;
 
-    #ifdef MANGOS_DEBUG
-
-    // Code for network use statistic
-    static uint64 sendPacketCount = 0;
-    static uint64 sendPacketBytes = 0;
-
-    static time_t firstTime = time(NULL);
-    static time_t lastTime = firstTime;                     // next 60 secs start time
-
-    static uint64 sendLastPacketCount = 0;
-    static uint64 sendLastPacketBytes = 0;
-
-    time_t cur_time = time(NULL);
-
-    if((cur_time - lastTime) < 60)
-    {
-        sendPacketCount+=1;
-        sendPacketBytes+=packet->size();
-
-        sendLastPacketCount+=1;
-        sendLastPacketBytes+=packet->size();
-    }
-    else
-    {
-        uint64 minTime = uint64(cur_time - lastTime);
-        uint64 fullTime = uint64(lastTime - firstTime);
-        sLog.outDetail("Send all time packets count: " UI64FMTD " bytes: " UI64FMTD " avr.count/sec: %f avr.bytes/sec: %f time: %u",sendPacketCount,sendPacketBytes,float(sendPacketCount)/fullTime,float(sendPacketBytes)/fullTime,uint32(fullTime));
-        sLog.outDetail("Send last min packets count: " UI64FMTD " bytes: " UI64FMTD " avr.count/sec: %f avr.bytes/sec: %f",sendLastPacketCount,sendLastPacketBytes,float(sendLastPacketCount)/minTime,float(sendLastPacketBytes)/minTime);
-
-        lastTime = cur_time;
-        sendLastPacketCount = 1;
-        sendLastPacketBytes = packet->wpos();               // wpos is real written size
-    }
-
-    #endif                                                  // !MANGOS_DEBUG
-
     if (m_Socket->SendPacket (*packet) == -1)
         m_Socket->CloseSocket ();
 }
 
 /// Add an incoming packet to the queue
-void WorldSession::QueuePacket(WorldPacket* new_packet)
+bool WorldSession::QueuePacket(WorldPacket* new_packet)
 {
-    _recvQueue.add(new_packet);
+    return _recvQueue.add(new_packet);
 }
 
 /// Logging helper for unexpected opcodes
@@ -156,112 +122,44 @@ void WorldSession::LogUnprocessedTail(WorldPacket *packet)
 }
 
 /// Update the WorldSession (triggered by World update)
-bool WorldSession::Update(uint32 /*diff*/)
+bool WorldSession::Update(uint32 /*diff*/, PacketFilter& updater)
 {
     ///- Retrieve packets from the receive queue and call the appropriate handlers
     /// not proccess packets if socket already closed
-    WorldPacket* packet;
-    while (_recvQueue.next(packet) && m_Socket && !m_Socket->IsClosed ())
+    WorldPacket* batch[WORLD_SESSION_RECV_BATCH_SIZE];
+    uint32 batchSize = 0;
+    uint32 batchPos = 0;
+
+    while (m_Socket && !m_Socket->IsClosed ())
     {
-        /*#if 1
-        sLog.outError( "MOEP: %s (0x%.4X)",
-                        LookupOpcodeName(packet->GetOpcode()),
-                        packet->GetOpcode());
-        #endif*/
-
-        OpcodeHandler& opHandle = opcodeTable[packet->GetOpcode()];
-        try
+        if (batchPos == batchSize)
         {
-            switch (opHandle.status)
-            {
-                case STATUS_LOGGEDIN:
-                    if(!_player)
-                    {
-                        // skip STATUS_LOGGEDIN opcode unexpected errors if player logout sometime ago - this can be network lag delayed packets
-                        if(!m_playerRecentlyLogout)
-                            LogUnexpectedOpcode(packet, "the player has not logged in yet");
-                    }
-                    else if(_player->IsInWorld())
-                    {
-                        (this->*opHandle.handler)(*packet);
-                        if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
-                    }
-                    // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
-                    break;
-                case STATUS_LOGGEDIN_OR_RECENTLY_LOGGEDOUT:
-                    if(!_player && !m_playerRecentlyLogout)
-                    {
-                        LogUnexpectedOpcode(packet, "the player has not logged in yet and not recently logout");
-                    }
-                    else
-                    {
-                        // not expected _player or must checked in packet hanlder
-                        (this->*opHandle.handler)(*packet);
-                        if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
-                    }
-                    break;
-                case STATUS_TRANSFER:
-                    if(!_player)
-                        LogUnexpectedOpcode(packet, "the player has not logged in yet");
-                    else if(_player->IsInWorld())
-                        LogUnexpectedOpcode(packet, "the player is still in world");
-                    else
-                    {
-                        (this->*opHandle.handler)(*packet);
-                        if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
-                            LogUnprocessedTail(packet);
-                    }
-                    break;
-                case STATUS_AUTHED:
-                    // prevent cheating with skip queue wait
-                    if(m_inQueue)
-                    {
-                        LogUnexpectedOpcode(packet, "the player not pass queue yet");
-                        break;
-                    }
-
-                    // single from authed time opcodes send in to after logout time
-                    // and before other STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT opcodes.
-                    if (packet->GetOpcode() != CMSG_SET_ACTIVE_VOICE_CHANNEL)
-                        m_playerRecentlyLogout = false;
+            _recvQueue.release(batchPos);
+            batchSize = _recvQueue.peek(batch, WORLD_SESSION_RECV_BATCH_SIZE);
+            batchPos = 0;
 
-                    (this->*opHandle.handler)(*packet);
-                    if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
-                        LogUnprocessedTail(packet);
-                    break;
-                case STATUS_NEVER:
-                    sLog.outError( "SESSION: received not allowed opcode %s (0x%.4X)",
-                        LookupOpcodeName(packet->GetOpcode()),
-                        packet->GetOpcode());
-                    break;
-                case STATUS_UNHANDLED:
-                    sLog.outDebug("SESSION: received not handled opcode %s (0x%.4X)",
-                        LookupOpcodeName(packet->GetOpcode()),
-                        packet->GetOpcode());
-                    break;
-                default:
-                    sLog.outError("SESSION: received wrong-status-req opcode %s (0x%.4X)",
-                        LookupOpcodeName(packet->GetOpcode()),
-                        packet->GetOpcode());
-                    break;
-            }
-        }
-        catch(ByteBufferException &)
-        {
-            sLog.outError("WorldSession::Update ByteBufferException occured while parsing a packet (opcode: %u) from client %s, accountid=%i. Skipped packet.",
-                    packet->GetOpcode(), GetRemoteAddress().c_str(), GetAccountId());
-            if(sLog.IsOutDebug())
-            {
-                sLog.outDebug("Dumping error causing packet:");
-                packet->hexlike();
-            }
+            if (!batchSize)
+                break;
         }
 
-        delete packet;
+        WorldPacket* packet = batch[batchPos];
+
+        ///- Stop at the first packet owned by the other thread, the other update continues from it
+        /// so packets of one session are always handled in the order they were received
+        if (!updater.Process(packet))
+            break;
+
+        ++batchPos;
+        ProcessPacket(packet);
     }
 
+    ///- Remove processed packets, the others wait for the next update
+    _recvQueue.release(batchPos);
+
+    ///- Logout and socket cleanup are done in world thread only
+    if (!updater.ProcessLogout())
+        return true;
+
     ///- Cleanup socket pointer if need
     if (m_Socket && m_Socket->IsClosed ())
     {
@@ -280,6 +178,147 @@ bool WorldSession::Update(uint32 /*diff*/)
     return true;
 }
 
+/// Call the handler of a received packet and delete it
+void WorldSession::ProcessPacket(WorldPacket* packet)
+{
+    /*#if 1
+    sLog.outError( "MOEP: %s (0x%.4X)",
+                    LookupOpcodeName(packet->GetOpcode()),
+                    packet->GetOpcode());
+    #endif*/
+
+    OpcodeHandler& opHandle = opcodeTable[packet->GetOpcode()];
+
+    bool measureTime = sWorld.getConfig(CONFIG_OPCODE_STATS_HANDLER_TIME);
+    uint64 startTime = measureTime ? OpcodeStatsMgr::GetHandlerClock() : 0;
+
+    try
+    {
+        switch (opHandle.status)
+        {
+            case STATUS_LOGGEDIN:
+                if(!_player)
+                {
+                    // skip STATUS_LOGGEDIN opcode unexpected errors if player logout sometime ago - this can be network lag delayed packets
+                    if(!m_playerRecentlyLogout)
+                        LogUnexpectedOpcode(packet, "the player has not logged in yet");
+                }
+                else if(_player->IsInWorld())
+                {
+                    (this->*opHandle.handler)(*packet);
+                    if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
+                        LogUnprocessedTail(packet);
+                }
+                // lag can cause STATUS_LOGGEDIN opcodes to arrive after the player started a transfer
+                break;
+            case STATUS_LOGGEDIN_OR_RECENTLY_LOGGEDOUT:
+                if(!_player && !m_playerRecentlyLogout)
+                {
+                    LogUnexpectedOpcode(packet, "the player has not logged in yet and not recently logout");
+                }
+                else
+                {
+                    // not expected _player or must checked in packet hanlder
+                    (this->*opHandle.handler)(*packet);
+                    if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
+                        LogUnprocessedTail(packet);
+                }
+                break;
+            case STATUS_TRANSFER:
+                if(!_player)
+                    LogUnexpectedOpcode(packet, "the player has not logged in yet");
+                else if(_player->IsInWorld())
+                    LogUnexpectedOpcode(packet, "the player is still in world");
+                else
+                {
+                    (this->*opHandle.handler)(*packet);
+                    if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
+                        LogUnprocessedTail(packet);
+                }
+                break;
+            case STATUS_AUTHED:
+                // prevent cheating with skip queue wait
+                if(m_inQueue)
+                {
+                    LogUnexpectedOpcode(packet, "the player not pass queue yet");
+                    break;
+                }
+
+                // single from authed time opcodes send in to after logout time
+                // and before other STATUS_LOGGEDIN_OR_RECENTLY_LOGGOUT opcodes.
+                if (packet->GetOpcode() != CMSG_SET_ACTIVE_VOICE_CHANNEL)
+                    m_playerRecentlyLogout = false;
+
+                (this->*opHandle.handler)(*packet);
+                if (sLog.IsOutDebug() && packet->rpos() < packet->wpos())
+                    LogUnprocessedTail(packet);
+                break;
+            case STATUS_NEVER:
+                sLog.outError( "SESSION: received not allowed opcode %s (0x%.4X)",
+                    LookupOpcodeName(packet->GetOpcode()),
+                    packet->GetOpcode());
+                break;
+            case STATUS_UNHANDLED:
+                sLog.outDebug("SESSION: received not handled opcode %s (0x%.4X)",
+                    LookupOpcodeName(packet->GetOpcode()),
+                    packet->GetOpcode());
+                break;
+            default:
+                sLog.outError("SESSION: received wrong-status-req opcode %s (0x%.4X)",
+                    LookupOpcodeName(packet->GetOpcode()),
+                    packet->GetOpcode());
+                break;
+        }
+    }
+    catch(ByteBufferException &)
+    {
+        sLog.outError("WorldSession::Update ByteBufferException occured while parsing a packet (opcode: %u) from client %s, accountid=%i. Skipped packet.",
+                packet->GetOpcode(), GetRemoteAddress().c_str(), GetAccountId());
+        if(sLog.IsOutDebug())
+        {
+            sLog.outDebug("Dumping error causing packet:");
+            packet->hexlike();
+        }
+    }
+
+    uint64 handlerTime = measureTime ? OpcodeStatsMgr::GetHandlerClock() - startTime : 0;
+
+    // per thread counters, session counters are safe as world and map updates of a session never run at once
+    sOpcodeStats.CountHandled(packet->GetOpcode(), handlerTime);
+    ++m_statPackets;
+    m_statBytes += packet->size();
+    m_statHandlerTime += handlerTime;
+
+    delete packet;
+}
+
+bool MapSessionFilter::Process(WorldPacket* packet)
+{
+    OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
+
+    if (opHandle.packetProcessing == PROCESS_INPLACE)
+        return true;
+
+    if (opHandle.packetProcessing == PROCESS_THREADUNSAFE)
+        return false;
+
+    // player may have left the map while processing previous packets
+    Player* plr = m_pSession->GetPlayer();
+    return plr && plr->IsInWorld();
+}
+
+bool WorldSessionFilter::Process(WorldPacket* packet)
+{
+    OpcodeHandler const& opHandle = opcodeTable[packet->GetOpcode()];
+
+    if (opHandle.packetProcessing != PROCESS_THREADSAFE)
+        return true;
+
+    // map of the player processes it, without map it is done (or rejected) here
+    Player* plr = m_pSession->GetPlayer();
+    return !plr || !plr->IsInWorld();
+}
+
 /// %Log the player out
 void WorldSession::LogoutPlayer(bool Save)
 {
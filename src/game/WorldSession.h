@@ -25,6 +25,7 @@
 
 #include "Common.h"
 #include "SharedDefines.h"
+#include "LockFreeQueue.h"
 
 struct ItemPrototype;
 struct AuctionEntry;
@@ -38,6 +39,7 @@ class Player;
 class Unit;
 class WorldPacket;
 class WorldSocket;
+class WorldSession;
 class QueryResult;
 class LoginQueryHolder;
 class CharacterHandler;
@@ -56,6 +58,13 @@ enum AccountDataType
     NUM_ACCOUNT_DATA_TYPES          = 8
 };
 
+// Size of the per-session receive ring. One socket read (4096 bytes of at least
+// 6 byte packets) may decode up to 683 packets after the backpressure check,
+// so this must stay above Network.InQueueLimit + 683 (see WorldSocketMgr).
+#define WORLD_SESSION_RECV_QUEUE_SIZE   1024
+// Packets taken from the receive ring per batch in WorldSession::Update
+#define WORLD_SESSION_RECV_BATCH_SIZE   32
+
 #define GLOBAL_CACHE_MASK           0x15
 #define PER_CHARACTER_CACHE_MASK    0xEA
 
@@ -104,6 +113,40 @@ enum PartyResult
     PARTY_RESULT_INVITE_RESTRICTED    = 13
 };
 
+/// Decides which received packets WorldSession::Update may process in the current thread
+class PacketFilter
+{
+    public:
+        explicit PacketFilter(WorldSession* pSession) : m_pSession(pSession) {}
+        virtual ~PacketFilter() {}
+
+        virtual bool Process(WorldPacket* /*packet*/) { return true; }
+        virtual bool ProcessLogout() const { return true; }
+
+    protected:
+        WorldSession* const m_pSession;
+};
+
+/// Used in Map::Update(), processes only PROCESS_THREADSAFE packets of players in world
+class MapSessionFilter : public PacketFilter
+{
+    public:
+        explicit MapSessionFilter(WorldSession* pSession) : PacketFilter(pSession) {}
+
+        virtual bool Process(WorldPacket* packet);
+        // logout is always done in world thread
+        virtual bool ProcessLogout() const { return false; }
+};
+
+/// Used in World::UpdateSessions(), leaves PROCESS_THREADSAFE packets of players in world to the map
+class WorldSessionFilter : public PacketFilter
+{
+    public:
+        explicit WorldSessionFilter(WorldSession* pSession) : PacketFilter(pSession) {}
+
+        virtual bool Process(WorldPacket* packet);
+};
+
 /// Player session in the World
 class MANGOS_DLL_SPEC WorldSession
 {
@@ -166,8 +209,11 @@ class MANGOS_DLL_SPEC WorldSession
         void LogoutPlayer(bool Save);
         void KickPlayer();
 
-        void QueuePacket(WorldPacket* new_packet);
-        bool Update(uint32 diff);
+        /// Called from the network thread only, returns false if the receive ring is full
+        bool QueuePacket(WorldPacket* new_packet);
+        /// Packets waiting in the receive ring, used by the socket for backpressure
+        uint32 GetQueuedPacketsCount() const { return uint32(_recvQueue.size()); }
+        bool Update(uint32 diff, PacketFilter& updater);
 
         /// Handle the authentication waiting queue (to be completed)
         void SendAuthWaitQue(uint32 position);
@@ -272,6 +318,12 @@ class MANGOS_DLL_SPEC WorldSession
 
         uint32 GetLatency() const { return m_latency; }
         void SetLatency(uint32 latency) { m_latency = latency; }
+
+        // traffic since the last opcode stats reset, see OpcodeStatsMgr
+        uint32 GetStatPackets() const { return m_statPackets; }
+        uint32 GetStatBytes() const { return m_statBytes; }
+        uint64 GetStatHandlerTime() const { return m_statHandlerTime; }
+        void ResetStats() { m_statPackets = 0; m_statBytes = 0; m_statHandlerTime = 0; }
         uint32 getDialogStatus(Player *pPlayer, Object* questgiver, uint32 defstatus);
 
     public:                                                 // opcodes handlers
@@ -744,6 +796,8 @@ class MANGOS_DLL_SPEC WorldSession
         void LogUnexpectedOpcode(WorldPacket *packet, const char * reason);
         void LogUnprocessedTail(WorldPacket *packet);
 
+        void ProcessPacket(WorldPacket* packet);
+
         uint32 m_GUIDLow;                                   // set loggined or recently logout player (while m_playerRecentlyLogout set)
         Player *_player;
         WorldSocket *m_Socket;
@@ -766,7 +820,12 @@ class MANGOS_DLL_SPEC WorldSession
         uint32 m_Tutorials[8];
         bool   m_TutorialsChanged;
         AddonsList m_addonsList;
-        ACE_Based::LockedQueue<WorldPacket*, ACE_Thread_Mutex> _recvQueue;
+        // single producer (socket reactor thread), single consumer (world thread)
+        ACE_Based::LockFreeQueue<WorldPacket*> _recvQueue;
+
+        uint32 m_statPackets;                               // handled packets since last stats reset
+        uint32 m_statBytes;
+        uint64 m_statHandlerTime;                           // in high resolution timer ticks, see OpcodeStatsMgr
 };
 #endif
 /// @}
@@ -42,6 +42,7 @@
 #include "WorldSession.h"
 #include "WorldSocketMgr.h"
 #include "Log.h"
+#include "OpcodeStats.h"
 
 #if defined( __GNUC__ )
 #pragma pack(1)
@@ -104,7 +105,9 @@ m_RecvPct (),
 m_Header (sizeof (ClientPktHeader)),
 m_OutBuffer (0),
 m_OutBufferSize (65536),
+m_OutBufferCrypted (0),
 m_OutActive (false),
+m_InActive (true),
 m_Seed (static_cast<uint32> (rand32 ())),
 m_OverSpeedPings (0),
 m_LastPingTime (ACE_Time_Value::zero)
@@ -167,8 +170,11 @@ int WorldSocket::SendPacket (const WorldPacket& pct)
     // Dump outgoing packet.
     sLog.outWorldPacketDump(uint32(get_handle()), pct.GetOpcode(), LookupOpcodeName(pct.GetOpcode()), &pct, false);
 
+    // The header is left in plain text here, it is encrypted by the network
+    // thread in EncryptOutput() right before it is sent.
     ServerPktHeader header(pct.size()+2, pct.GetOpcode());
-    m_Crypt.EncryptSend ((uint8*)header.header, header.getHeaderLength());
+
+    sOpcodeStats.CountSent(pct.GetOpcode(), pct.size() + header.getHeaderLength());
 
     if (m_OutBuffer->space () >= pct.size () + header.getHeaderLength() && msg_queue()->is_empty())
     {
@@ -179,6 +185,10 @@ int WorldSocket::SendPacket (const WorldPacket& pct)
         if (!pct.empty ())
             if (m_OutBuffer->copy ((char*) pct.contents (), pct.size ()) == -1)
                 ACE_ASSERT (false);
+
+        // sent before the crypt was initialized, must stay plain text
+        if (!m_Crypt.IsInitialized ())
+            m_OutBufferCrypted = m_OutBuffer->wr_ptr () - m_OutBuffer->base ();
     }
     else
     {
@@ -192,6 +202,9 @@ int WorldSocket::SendPacket (const WorldPacket& pct)
         if (!pct.empty ())
             mb->copy((const char*)pct.contents(), pct.size ());
 
+        if (!m_Crypt.IsInitialized ())
+            mb->set_flags (MB_HEADER_CRYPTED);
+
         if(msg_queue()->enqueue_tail(mb,(ACE_Time_Value*)&ACE_Time_Value::zero) == -1)
         {
             sLog.outError("WorldSocket::SendPacket enqueue_tail");
@@ -284,6 +297,10 @@ int WorldSocket::handle_input (ACE_HANDLE)
     if (closing_)
         return -1;
 
+    // World thread is behind on this session, leave the data in the kernel buffer
+    if (IsInputQueueFull ())
+        return pause_input ();
+
     switch (handle_input_missing_data ())
     {
         case -1 :
@@ -327,6 +344,8 @@ int WorldSocket::handle_output (ACE_HANDLE)
     if (send_len == 0)
         return handle_output_queue (Guard);
 
+    EncryptOutput ();
+
 #ifdef MSG_NOSIGNAL
     ssize_t n = peer ().send (m_OutBuffer->rd_ptr (), send_len, MSG_NOSIGNAL);
 #else
@@ -349,11 +368,15 @@ int WorldSocket::handle_output (ACE_HANDLE)
         // move the data to the base of the buffer
         m_OutBuffer->crunch ();
 
+        // everything left in the buffer was encrypted above
+        m_OutBufferCrypted = m_OutBuffer->length ();
+
         return schedule_wakeup_output (Guard);
     }
     else //now n == send_len
     {
         m_OutBuffer->reset ();
+        m_OutBufferCrypted = 0;
 
         return handle_output_queue (Guard);
     }
@@ -374,6 +397,13 @@ int WorldSocket::handle_output_queue (GuardType& g)
         return -1;
     }
 
+    // queued blocks hold exactly one packet, the header is at the base
+    if (!(mblk->flags () & MB_HEADER_CRYPTED))
+    {
+        EncryptHeader ((uint8*) mblk->base ());
+        mblk->set_flags (MB_HEADER_CRYPTED);
+    }
+
     const size_t send_len = mblk->length ();
 
 #ifdef MSG_NOSIGNAL
@@ -422,6 +452,39 @@ int WorldSocket::handle_output_queue (GuardType& g)
     ACE_NOTREACHED(return -1);
 }
 
+size_t WorldSocket::EncryptHeader (uint8* header)
+{
+    // header is still plain text: size (2 or 3 bytes, big endian, 0x80 flags the 3 byte form) + opcode
+    size_t size;
+    size_t header_len;
+
+    if (header[0] & 0x80)
+    {
+        size = ((header[0] & 0x7F) << 16) | (header[1] << 8) | header[2];
+        header_len = 5;
+    }
+    else
+    {
+        size = (header[0] << 8) | header[1];
+        header_len = 4;
+    }
+
+    m_Crypt.EncryptSend (header, header_len);
+
+    // size counts the opcode, which is part of the header
+    return header_len + size - 2;
+}
+
+void WorldSocket::EncryptOutput (void)
+{
+    uint8* const base = (uint8*) m_OutBuffer->base ();
+    const size_t end = m_OutBuffer->wr_ptr () - m_OutBuffer->base ();
+
+    // walk all packets added since the last flush, in wire order
+    while (m_OutBufferCrypted < end)
+        m_OutBufferCrypted += EncryptHeader (base + m_OutBufferCrypted);
+}
+
 int WorldSocket::handle_close (ACE_HANDLE h, ACE_Reactor_Mask)
 {
     // Critical section
@@ -449,6 +512,12 @@ int WorldSocket::Update (void)
     if (closing_)
         return -1;
 
+    if (!m_InActive && !IsInputQueueFull ())
+    {
+        if (resume_input () == -1)
+            return -1;
+    }
+
     if (m_OutActive || (m_OutBuffer->length () == 0 && msg_queue()->is_empty()))
         return 0;
 
@@ -611,6 +680,47 @@ int WorldSocket::handle_input_missing_data (void)
     return n == recv_size ? 1 : 2;
 }
 
+bool WorldSocket::IsInputQueueFull (void)
+{
+    ACE_GUARD_RETURN (LockType, Guard, m_SessionLock, false);
+
+    return m_Session && m_Session->GetQueuedPacketsCount () >= sWorldSocketMgr->GetInQueueLimit ();
+}
+
+int WorldSocket::pause_input (void)
+{
+    if (!m_InActive)
+        return 0;
+
+    m_InActive = false;
+
+    if (reactor ()->cancel_wakeup
+        (this, ACE_Event_Handler::READ_MASK) == -1)
+    {
+        sLog.outError ("WorldSocket::pause_input");
+        return -1;
+    }
+
+    return 0;
+}
+
+int WorldSocket::resume_input (void)
+{
+    if (m_InActive)
+        return 0;
+
+    m_InActive = true;
+
+    if (reactor ()->schedule_wakeup
+        (this, ACE_Event_Handler::READ_MASK) == -1)
+    {
+        sLog.outError ("WorldSocket::resume_input");
+        return -1;
+    }
+
+    return 0;
+}
+
 int WorldSocket::cancel_wakeup_output (GuardType& g)
 {
     if (!m_OutActive)
@@ -671,6 +781,8 @@ int WorldSocket::ProcessIncoming (WorldPacket* new_pct)
     // Dump received packet.
     sLog.outWorldPacketDump(uint32(get_handle()), new_pct->GetOpcode(), LookupOpcodeName(new_pct->GetOpcode()), new_pct, true);
 
+    sOpcodeStats.CountReceived(opcode, new_pct->size() + sizeof(ClientPktHeader));
+
     try
     {
         switch(opcode)
@@ -696,10 +808,17 @@ int WorldSocket::ProcessIncoming (WorldPacket* new_pct)
                 if (m_Session != NULL)
                 {
                     // OK ,give the packet to WorldSession
-                    aptr.release ();
                     // WARNINIG here we call it with locks held.
                     // Its possible to cause deadlock if QueuePacket calls back
-                    m_Session->QueuePacket (new_pct);
+                    if (!m_Session->QueuePacket (new_pct))
+                    {
+                        // can't happen while input is paused at Network.InQueueLimit, so this is a flood
+                        sLog.outError ("WorldSocket::ProcessIncoming: receive queue overflow, opcode = %u, address = %s",
+                                       uint32(opcode), GetRemoteAddress ().c_str ());
+                        return -1;
+                    }
+
+                    aptr.release ();
                     return 0;
                 }
                 else
@@ -942,7 +1061,12 @@ int WorldSocket::HandleAuthSession (WorldPacket& recvPacket)
     // NOTE ATM the socket is single-threaded, have this in mind ...
     ACE_NEW_RETURN (m_Session, WorldSession (id, this, AccountTypes(security), expansion, mutetime, locale), -1);
 
-    m_Crypt.Init(&K);
+    // SendPacket checks the crypt state under this lock
+    {
+        ACE_GUARD_RETURN (LockType, Guard, m_OutBufferLock, -1);
+
+        m_Crypt.Init(&K);
+    }
 
     m_Session->LoadGlobalAccountData();
     m_Session->LoadTutorialsData();
@@ -97,6 +97,9 @@ class WorldSocket : protected WorldHandler
         /// Declare the acceptor for this class
         typedef ACE_Acceptor< WorldSocket, ACE_SOCK_ACCEPTOR > Acceptor;
 
+        /// Flag of queued output blocks whose header is already encrypted.
+        static const ACE_Message_Block::Message_Flags MB_HEADER_CRYPTED = ACE_Message_Block::USER_FLAGS;
+
         /// Mutex type used for various synchronizations.
         typedef ACE_Thread_Mutex LockType;
         typedef ACE_Guard<LockType> GuardType;
@@ -156,6 +159,20 @@ class WorldSocket : protected WorldHandler
         int cancel_wakeup_output (GuardType& g);
         int schedule_wakeup_output (GuardType& g);
 
+        /// Backpressure helpers, stop/restart reading from the socket while
+        /// the session receive queue is at Network.InQueueLimit.
+        /// Called only from the reactor thread owning the socket.
+        bool IsInputQueueFull (void);
+        int pause_input (void);
+        int resume_input (void);
+
+        /// Encrypt the header of one plain text packet in the output, return the packet size.
+        size_t EncryptHeader (uint8* header);
+
+        /// Encrypt all packet headers added to m_OutBuffer since the last call.
+        /// Called by the network thread before sending, m_OutBufferLock must be held.
+        void EncryptOutput (void);
+
         /// Drain the queue if its not empty.
         int handle_output_queue (GuardType& g);
 
@@ -208,9 +225,15 @@ class WorldSocket : protected WorldHandler
         /// Size of the m_OutBuffer.
         size_t m_OutBufferSize;
 
+        /// Offset from m_OutBuffer base up to which packet headers are encrypted.
+        size_t m_OutBufferCrypted;
+
         /// True if the socket is registered with the reactor for output
         bool m_OutActive;
 
+        /// False while reading is paused because the session receive queue is full
+        bool m_InActive;
+
         uint32 m_Seed;
 };
 
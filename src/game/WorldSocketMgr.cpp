@@ -43,6 +43,7 @@
 #include "Config/ConfigEnv.h"
 #include "Database/DatabaseEnv.h"
 #include "WorldSocket.h"
+#include "WorldSession.h"
 
 /**
 * This is a helper class to WorldSocketMgr ,that manages
@@ -211,6 +212,7 @@ WorldSocketMgr::WorldSocketMgr () :
     m_NetThreads (0),
     m_SockOutKBuff (-1),
     m_SockOutUBuff (65536),
+    m_InQueueLimit (256),
     m_UseNoDelay (true),
     m_Acceptor (0)
 {
@@ -255,6 +257,19 @@ WorldSocketMgr::StartReactiveIO (ACE_UINT16 port, const char* address)
         return -1;
     }
 
+    // one socket read may queue up to 683 more packets after the limit check
+    const int max_in_queue = WORLD_SESSION_RECV_QUEUE_SIZE - 4096 / 6 - 1;
+
+    int in_queue = sConfig.GetIntDefault ("Network.InQueueLimit", 256);
+
+    if (in_queue <= 0 || in_queue > max_in_queue)
+    {
+        sLog.outError ("Network.InQueueLimit (%d) must be in range 1..%d, set to %d", in_queue, max_in_queue, max_in_queue);
+        in_queue = max_in_queue;
+    }
+
+    m_InQueueLimit = static_cast<size_t> (in_queue);
+
     WorldSocket::Acceptor *acc = new WorldSocket::Acceptor;
     m_Acceptor = acc;
 
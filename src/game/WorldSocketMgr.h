@@ -52,6 +52,9 @@ public:
   /// Make this class singleton .
   static WorldSocketMgr* Instance ();
 
+  /// Received packets a session may have queued before its socket stops reading .
+  size_t GetInQueueLimit () const { return m_InQueueLimit; }
+
 private:
   int OnSocketOpen(WorldSocket* sock);
 
@@ -66,6 +69,7 @@ private:
 
   int m_SockOutKBuff;
   int m_SockOutUBuff;
+  size_t m_InQueueLimit;
   bool m_UseNoDelay;
 
   ACE_Event_Handler* m_Acceptor;
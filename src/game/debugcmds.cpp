@@ -32,6 +32,10 @@
 #include "ObjectMgr.h"
 #include "ObjectDefines.h"
 #include "SpellMgr.h"
+#include "OpcodeStats.h"
+#include "World.h"
+#include "ObjectPool.h"
+#include "VMapFactory.h"
 
 bool ChatHandler::HandleDebugSendSpellFailCommand(const char* args)
 {
@@ -658,6 +662,67 @@ bool ChatHandler::HandleDebugSpellCheckCommand(const char* /*args*/)
     return true;
 }
 
+bool ChatHandler::HandleDebugObjectPoolsCommand(const char* /*args*/)
+{
+    ObjectPool::SendReport(this);
+    return true;
+}
+
+bool ChatHandler::HandleDebugLineOfSightCommand(const char* /*args*/)
+{
+    unsigned long long hits, misses;
+    VMAP::VMapFactory::createOrGetVMapManager()->getLineOfSightCacheStats(hits, misses);
+
+    unsigned long long total = hits + misses;
+    PSendSysMessage("Line of sight cache: " UI64FMTD " hits, " UI64FMTD " misses, hit rate %.1f%%",
+        uint64(hits), uint64(misses), total ? float(hits) * 100.0f / float(total) : 0.0f);
+    return true;
+}
+
+bool ChatHandler::HandleDebugOpcodeStatsCommand(const char* args)
+{
+    uint32 count = 10;
+    OpcodeStatSort sort = sWorld.getConfig(CONFIG_OPCODE_STATS_HANDLER_TIME) ? OPCODE_STAT_SORT_TIME : OPCODE_STAT_SORT_COUNT;
+
+    for (char* arg = strtok((char*)args, " "); arg; arg = strtok(NULL, " "))
+    {
+        if (isdigit(*arg))
+            count = atoi(arg);
+        else if (strncmp(arg, "time", strlen(arg)) == 0)
+            sort = OPCODE_STAT_SORT_TIME;
+        else if (strncmp(arg, "count", strlen(arg)) == 0)
+            sort = OPCODE_STAT_SORT_COUNT;
+        else if (strncmp(arg, "in", strlen(arg)) == 0)
+            sort = OPCODE_STAT_SORT_BYTES_IN;
+        else if (strncmp(arg, "out", strlen(arg)) == 0)
+            sort = OPCODE_STAT_SORT_BYTES_OUT;
+        else if (strncmp(arg, "reset", strlen(arg)) == 0)
+        {
+            sOpcodeStats.Reset();
+            SendSysMessage("Opcode stats reset.");
+            return true;
+        }
+        else
+            return false;
+    }
+
+    if (!count)
+        return false;
+
+    sOpcodeStats.SendReport(this, count, sort);
+    return true;
+}
+
+bool ChatHandler::HandleDebugTopTalkersCommand(const char* args)
+{
+    uint32 count = *args ? atoi(args) : 10;
+    if (!count)
+        return false;
+
+    sOpcodeStats.SendTopTalkers(this, count);
+    return true;
+}
+
 bool ChatHandler::HandleDebugSendLargePacketCommand(const char* /*args*/)
 {
     const char* stuffingString = "This is a dummy string to push the packet's size beyond 128000 bytes. ";
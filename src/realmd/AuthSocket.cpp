@@ -27,6 +27,7 @@
 #include "RealmList.h"
 #include "AuthSocket.h"
 #include "AuthCodes.h"
+#include "AuthWorker.h"
 #include <openssl/md5.h>
 //#include "Util.h" -- for commented utf8ToUpperOnlyLatin
 
@@ -227,19 +228,23 @@ const AuthHandler table[] =
 Patcher PatchesCache;
 
 /// Constructor - set the N and g values for SRP6
-AuthSocket::AuthSocket(ISocketHandler &h) : TcpSocket(h)
+AuthSession::AuthSession() : authed(false), build(0), accountId(0), accountSecurityLevel(SEC_PLAYER)
 {
     N.SetHexStr("894B645E89E1535BBDAD5B8B290650530801B18EBFBF5E8FAB3C82872A3E9BB7");
     g.SetDword(7);
-    _authed = false;
-    pPatch = NULL;
+}
 
-    _accountSecurityLevel = SEC_PLAYER;
+AuthSocket::AuthSocket(ISocketHandler &h) : TcpSocket(h), pPatch(NULL), _pendingRequest(NULL)
+{
 }
 
 /// Close patch file descriptor before leaving
 AuthSocket::~AuthSocket()
 {
+    ///- A request still in work must not report back to us
+    if (_pendingRequest)
+        _pendingRequest->socket = NULL;
+
     ACE_Guard<ACE_Thread_Mutex> g(patcherLock);
 
     if(pPatch)
@@ -252,6 +257,7 @@ void AuthSocket::OnAccept()
     sLog.outBasic("Accepting connection from '%s:%d'",
         GetRemoteAddress().c_str(), GetRemotePort());
 
+    _session.remoteAddress = GetRemoteAddress();
 }
 
 /// Read the packet from the client
@@ -259,9 +265,20 @@ void AuthSocket::OnRead()
 {
     ///- Read the packet
     TcpSocket::OnRead();
+
+    ProcessInput();
+}
+
+/// Call the command handlers for the received data
+void AuthSocket::ProcessInput()
+{
     uint8 _cmd;
     while (1)
     {
+        ///- Commands are processed in order, the rest waits for the one in work
+        if (_pendingRequest)
+            return;
+
         if (!ibuf.GetLength())
             return;
 
@@ -275,7 +292,7 @@ void AuthSocket::OnRead()
         {
             if ((uint8)table[i].cmd == _cmd &&
                 (table[i].status == STATUS_CONNECTED ||
-                (_authed && table[i].status == STATUS_AUTHED)))
+                (_session.authed && table[i].status == STATUS_AUTHED)))
             {
                 DEBUG_LOG("[Auth] got data for cmd %u ibuf length %u", (uint32)_cmd, ibuf.GetLength());
 
@@ -297,8 +314,41 @@ void AuthSocket::OnRead()
     }
 }
 
+/// Move a complete command from the input buffer to the auth workers
+void AuthSocket::QueueRequest(AuthRequest::Handler handler, size_t size)
+{
+    AuthRequest* request = new AuthRequest(this, handler, _session);
+
+    request->input.resize(size);
+    ibuf.Read((char*)request->input.contents(), size);
+
+    _pendingRequest = request;
+    sAuthWorkerPool.Schedule(request);
+}
+
+/// Take over the new session state and send the reply
+void AuthSocket::OnRequestDone(AuthRequest* request)
+{
+    ASSERT(request == _pendingRequest);
+    _pendingRequest = NULL;
+
+    _session = request->session;
+
+    if (!request->output.empty())
+        SendBuf((char const*)request->output.contents(), request->output.size());
+
+    if (!request->result)
+    {
+        SetCloseAndDelete();
+        return;
+    }
+
+    ///- Continue with the commands received meanwhile
+    ProcessInput();
+}
+
 /// Make the SRP6 calculation from hash in dB
-void AuthSocket::_SetVSFields(const std::string& rI)
+void AuthSession::SetVSFields(const std::string& rI)
 {
     s.SetRand(s_BYTE_SIZE * 8);
 
@@ -324,14 +374,14 @@ void AuthSocket::_SetVSFields(const std::string& rI)
     const char *v_hex, *s_hex;
     v_hex = v.AsHexStr();
     s_hex = s.AsHexStr();
-    loginDatabase.PExecute("UPDATE account SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, _safelogin.c_str() );
+    loginDatabase.PExecute("UPDATE account SET v = '%s', s = '%s' WHERE username = '%s'", v_hex, s_hex, safelogin.c_str() );
     OPENSSL_free((void*)v_hex);
     OPENSSL_free((void*)s_hex);
 }
 
-void AuthSocket::SendProof(Sha1Hash sha)
+void AuthSession::SendProof(ByteBuffer& output, Sha1Hash& sha)
 {
-    switch(_build)
+    switch(build)
     {
         case 5875:                                          // 1.12.1
         case 6005:                                          // 1.12.2
@@ -342,7 +392,7 @@ void AuthSocket::SendProof(Sha1Hash sha)
             proof.error = 0;
             proof.unk2 = 0x00;
 
-            SendBuf((char *)&proof, sizeof(proof));
+            output.append((uint8 const*)&proof, sizeof(proof));
             break;
         }
         case 8606:                                          // 2.4.3
@@ -358,44 +408,57 @@ void AuthSocket::SendProof(Sha1Hash sha)
             proof.unk2 = 0x00;
             proof.unk3 = 0x00;
 
-            SendBuf((char *)&proof, sizeof(proof));
+            output.append((uint8 const*)&proof, sizeof(proof));
             break;
         }
     }
 }
 
-/// Logon Challenge command handler
-bool AuthSocket::_HandleLogonChallenge()
+/// Check the logon and reconnect challenge header, returns the full command size or 0 if incomplete
+size_t AuthSocket::GetChallengeSize()
 {
-    DEBUG_LOG("Entering _HandleLogonChallenge");
     if (ibuf.GetLength() < sizeof(sAuthLogonChallenge_C))
-        return false;
-
-    ///- Read the first 4 bytes (header) to get the length of the remaining of the packet
-    std::vector<uint8> buf;
-    buf.resize(4);
+        return 0;
 
-    ibuf.Read((char *)&buf[0], 4);
+    ///- Peek the first 4 bytes (header) to get the length of the remaining of the packet
+    uint8 header[4];
+    ibuf.SoftRead((char *)header, 4);
 
-    EndianConvert(*((uint16*)(buf[0])));
-    uint16 remaining = ((sAuthLogonChallenge_C *)&buf[0])->size;
+    uint16 remaining = ((sAuthLogonChallenge_C *)header)->size;
+    EndianConvert(remaining);
     DEBUG_LOG("[AuthChallenge] got header, body is %#04x bytes", remaining);
 
-    if ((remaining < sizeof(sAuthLogonChallenge_C) - buf.size()) || (ibuf.GetLength() < remaining))
+    if ((remaining < sizeof(sAuthLogonChallenge_C) - sizeof(header)) || (ibuf.GetLength() < sizeof(header) + remaining))
+        return 0;
+
+    return sizeof(header) + remaining;
+}
+
+/// Logon Challenge command handler
+bool AuthSocket::_HandleLogonChallenge()
+{
+    DEBUG_LOG("Entering _HandleLogonChallenge");
+
+    size_t size = GetChallengeSize();
+    if (!size)
         return false;
 
+    ///- Database lookups and SRP6 math are done by the auth workers
+    QueueRequest(&AuthSession::LogonChallenge, size);
+    return true;
+}
+
+bool AuthSession::LogonChallenge(ByteBuffer& input, ByteBuffer& output)
+{
     //No big fear of memory outage (size is int16, i.e. < 65536)
-    buf.resize(remaining + buf.size() + 1);
-    buf[buf.size() - 1] = 0;
+    std::vector<uint8> buf(input.contents(), input.contents() + input.size());
+    buf.push_back(0);
     sAuthLogonChallenge_C *ch = (sAuthLogonChallenge_C*)&buf[0];
 
-    ///- Read the remaining of the packet
-    ibuf.Read((char *)&buf[4], remaining);
-    DEBUG_LOG("[AuthChallenge] got full packet, %#04x bytes", ch->size);
+    DEBUG_LOG("[AuthChallenge] got full packet, %#04x bytes", input.size() - 4);
     DEBUG_LOG("[AuthChallenge] name(%d): '%s'", ch->I_len, ch->I);
 
     // BigEndian code, nop in little endian case
-    // size already converted
     EndianConvert(*((uint32*)(&ch->gamename[0])));
     EndianConvert(ch->build);
     EndianConvert(*((uint32*)(&ch->platform[0])));
@@ -404,25 +467,24 @@ bool AuthSocket::_HandleLogonChallenge()
     EndianConvert(ch->timezone_bias);
     EndianConvert(ch->ip);
 
-    ByteBuffer pkt;
+    ByteBuffer& pkt = output;
 
-    _login = (const char*)ch->I;
-    _build = ch->build;
+    login = (const char*)ch->I;
+    build = ch->build;
 
     ///- Normalize account name
-    //utf8ToUpperOnlyLatin(_login); -- client already send account in expected form
+    //utf8ToUpperOnlyLatin(login); -- client already send account in expected form
 
     //Escape the user login to avoid further SQL injection
-    //Memory will be freed on AuthSocket object destruction
-    _safelogin = _login;
-    loginDatabase.escape_string(_safelogin);
+    safelogin = login;
+    loginDatabase.escape_string(safelogin);
 
     pkt << (uint8) AUTH_LOGON_CHALLENGE;
     pkt << (uint8) 0x00;
 
     ///- Verify that this IP is not in the ip_banned table
     // No SQL injection possible (paste the IP address as passed by the socket)
-    std::string address = GetRemoteAddress();
+    std::string address = remoteAddress;
     loginDatabase.escape_string(address);
     QueryResult *result = loginDatabase.PQuery("SELECT unbandate FROM ip_banned WHERE "
     //    permanent                    still banned
@@ -430,7 +492,7 @@ bool AuthSocket::_HandleLogonChallenge()
     if (result)
     {
         pkt << (uint8)REALM_AUTH_ACCOUNT_BANNED;
-        sLog.outBasic("[AuthChallenge] Banned ip %s tries to login!", GetRemoteAddress().c_str());
+        sLog.outBasic("[AuthChallenge] Banned ip %s tries to login!", remoteAddress.c_str());
         delete result;
     }
     else
@@ -438,16 +500,16 @@ bool AuthSocket::_HandleLogonChallenge()
         ///- Get the account details from the account table
         // No SQL injection (escaped user name)
 
-        result = loginDatabase.PQuery("SELECT sha_pass_hash,id,locked,last_ip,gmlevel,v,s FROM account WHERE username = '%s'",_safelogin.c_str ());
+        result = loginDatabase.PQuery("SELECT sha_pass_hash,id,locked,last_ip,gmlevel,v,s FROM account WHERE username = '%s'",safelogin.c_str ());
         if( result )
         {
             ///- If the IP is 'locked', check that the player comes indeed from the correct IP address
             bool locked = false;
             if((*result)[2].GetUInt8() == 1)                // if ip is locked
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", _login.c_str(), (*result)[3].GetString());
-                DEBUG_LOG("[AuthChallenge] Player address is '%s'", GetRemoteAddress().c_str());
-                if ( strcmp((*result)[3].GetString(),GetRemoteAddress().c_str()) )
+                DEBUG_LOG("[AuthChallenge] Account '%s' is locked to IP - '%s'", login.c_str(), (*result)[3].GetString());
+                DEBUG_LOG("[AuthChallenge] Player address is '%s'", remoteAddress.c_str());
+                if ( strcmp((*result)[3].GetString(),remoteAddress.c_str()) )
                 {
                     DEBUG_LOG("[AuthChallenge] Account IP differs");
                     pkt << (uint8) REALM_AUTH_ACCOUNT_FREEZED;
@@ -460,7 +522,7 @@ bool AuthSocket::_HandleLogonChallenge()
             }
             else
             {
-                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", _login.c_str());
+                DEBUG_LOG("[AuthChallenge] Account '%s' is not locked to ip", login.c_str());
             }
 
             if (!locked)
@@ -473,12 +535,12 @@ bool AuthSocket::_HandleLogonChallenge()
                     if((*banresult)[0].GetUInt64() != (*banresult)[1].GetUInt64())
                     {
                         pkt << (uint8) REALM_AUTH_ACCOUNT_BANNED;
-                        sLog.outBasic("[AuthChallenge] Banned account %s tries to login!",_login.c_str ());
+                        sLog.outBasic("[AuthChallenge] Banned account %s tries to login!",login.c_str ());
                     }
                     else
                     {
                         pkt << (uint8) REALM_AUTH_ACCOUNT_FREEZED;
-                        sLog.outBasic("[AuthChallenge] Temporarily banned account %s tries to login!",_login.c_str ());
+                        sLog.outBasic("[AuthChallenge] Temporarily banned account %s tries to login!",login.c_str ());
                     }
 
                     delete banresult;
@@ -496,7 +558,7 @@ bool AuthSocket::_HandleLogonChallenge()
 
                     // multiply with 2, bytes are stored as hexstring
                     if(databaseV.size() != s_BYTE_SIZE*2 || databaseS.size() != s_BYTE_SIZE*2)
-                        _SetVSFields(rI);
+                        SetVSFields(rI);
                     else
                     {
                         s.SetHexStr(databaseS.c_str());
@@ -546,14 +608,16 @@ bool AuthSocket::_HandleLogonChallenge()
                         pkt << uint8(1);
                     }
 
+                    accountId = (*result)[1].GetUInt32();
+
                     uint8 secLevel = (*result)[4].GetUInt8();
-                    _accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
+                    accountSecurityLevel = secLevel <= SEC_ADMINISTRATOR ? AccountTypes(secLevel) : SEC_ADMINISTRATOR;
 
-                    _localizationName.resize(4);
+                    localizationName.resize(4);
                     for(int i = 0; i < 4; ++i)
-                        _localizationName[i] = ch->country[4-i-1];
+                        localizationName[i] = ch->country[4-i-1];
 
-                    sLog.outBasic("[AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", _login.c_str (), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(_localizationName));
+                    sLog.outBasic("[AuthChallenge] account %s is using '%c%c%c%c' locale (%u)", login.c_str (), ch->country[3], ch->country[2], ch->country[1], ch->country[0], GetLocaleByName(localizationName));
                 }
             }
             delete result;
@@ -563,7 +627,6 @@ bool AuthSocket::_HandleLogonChallenge()
             pkt<< (uint8) REALM_AUTH_NO_MATCH;
         }
     }
-    SendBuf((char const*)pkt.contents(), pkt.size());
     return true;
 }
 
@@ -574,20 +637,18 @@ bool AuthSocket::_HandleLogonProof()
     ///- Read the packet
     if (ibuf.GetLength() < sizeof(sAuthLogonProof_C))
         return false;
-    sAuthLogonProof_C lp;
-    ibuf.Read((char *)&lp, sizeof(sAuthLogonProof_C));
 
     ///- Check if the client has one of the expected version numbers
     bool valid_version = false;
     int accepted_versions[] = EXPECTED_REALMD_CLIENT_BUILD;
-    if (_build >= accepted_versions[0])                     // first build is low bound of always accepted range
+    if (_session.build >= accepted_versions[0])             // first build is low bound of always accepted range
         valid_version = true;
     else
     {
         // continue from 1 with explict equal check
         for(int i = 1; accepted_versions[i]; ++i)
         {
-            if(_build == accepted_versions[i])
+            if(_session.build == accepted_versions[i])
             {
                 valid_version = true;
                 break;
@@ -595,60 +656,73 @@ bool AuthSocket::_HandleLogonProof()
         }
     }
 
-    /// <ul><li> If the client has no valid version
-    if(!valid_version)
+    ///- Continue the SRP6 calculation in the auth workers
+    if (valid_version)
     {
-        ///- Check if we have the apropriate patch on the disk
+        QueueRequest(&AuthSession::LogonProof, sizeof(sAuthLogonProof_C));
+        return true;
+    }
+
+    sAuthLogonProof_C lp;
+    ibuf.Read((char *)&lp, sizeof(sAuthLogonProof_C));
 
-        // 24 = len("./patches/65535enGB.mpq")+1
-        char tmp[24];
-        // No buffer overflow (fixed length of arguments)
-        sprintf(tmp, "./patches/%d%s.mpq", _build, _localizationName.c_str());
-        // This will be closed at the destruction of the AuthSocket (client disconnection)
-        FILE *pFile = fopen(tmp, "rb");
+    /// <ul><li> If the client has no valid version
+    ///- Check if we have the apropriate patch on the disk
+
+    // 24 = len("./patches/65535enGB.mpq")+1
+    char tmp[24];
+    // No buffer overflow (fixed length of arguments)
+    sprintf(tmp, "./patches/%d%s.mpq", _session.build, _session.localizationName.c_str());
+    // This will be closed at the destruction of the AuthSocket (client disconnection)
+    FILE *pFile = fopen(tmp, "rb");
 
-        if(!pFile)
+    if(!pFile)
+    {
+        ByteBuffer pkt;
+        pkt << (uint8) AUTH_LOGON_CHALLENGE;
+        pkt << (uint8) 0x00;
+        pkt << (uint8) REALM_AUTH_WRONG_BUILD_NUMBER;
+        DEBUG_LOG("[AuthChallenge] %u is not a valid client version!", _session.build);
+        DEBUG_LOG("[AuthChallenge] Patch %s not found", tmp);
+        SendBuf((char const*)pkt.contents(), pkt.size());
+        return true;
+    }
+    else                                                    // have patch
+    {
+        pPatch = pFile;
+        XFER_INIT xferh;
+
+        ///- Get the MD5 hash of the patch file (get it from preloaded Patcher cache or calculate it)
+        if(PatchesCache.GetHash(tmp, (uint8*)&xferh.md5))
         {
-            ByteBuffer pkt;
-            pkt << (uint8) AUTH_LOGON_CHALLENGE;
-            pkt << (uint8) 0x00;
-            pkt << (uint8) REALM_AUTH_WRONG_BUILD_NUMBER;
-            DEBUG_LOG("[AuthChallenge] %u is not a valid client version!", _build);
-            DEBUG_LOG("[AuthChallenge] Patch %s not found", tmp);
-            SendBuf((char const*)pkt.contents(), pkt.size());
-            return true;
+            DEBUG_LOG("\n[AuthChallenge] Found precached patch info for patch %s", tmp);
+        }
+        else
+        {                                                   // calculate patch md5
+            printf("\n[AuthChallenge] Patch info for %s was not cached.", tmp);
+            PatchesCache.LoadPatchMD5(tmp);
+            PatchesCache.GetHash(tmp, (uint8*)&xferh.md5);
         }
-        else                                                // have patch
-        {
-            pPatch = pFile;
-            XFER_INIT xferh;
-
-            ///- Get the MD5 hash of the patch file (get it from preloaded Patcher cache or calculate it)
-            if(PatchesCache.GetHash(tmp, (uint8*)&xferh.md5))
-            {
-                DEBUG_LOG("\n[AuthChallenge] Found precached patch info for patch %s", tmp);
-            }
-            else
-            {                                               // calculate patch md5
-                printf("\n[AuthChallenge] Patch info for %s was not cached.", tmp);
-                PatchesCache.LoadPatchMD5(tmp);
-                PatchesCache.GetHash(tmp, (uint8*)&xferh.md5);
-            }
 
-            ///- Send a packet to the client with the file length and MD5 hash
-            uint8 data[2] = { AUTH_LOGON_PROOF, REALM_AUTH_UPDATE_CLIENT };
-            SendBuf((const char*)data, sizeof(data));
+        ///- Send a packet to the client with the file length and MD5 hash
+        uint8 data[2] = { AUTH_LOGON_PROOF, REALM_AUTH_UPDATE_CLIENT };
+        SendBuf((const char*)data, sizeof(data));
 
-            memcpy(&xferh, "0\x05Patch", 7);
-            xferh.cmd = XFER_INITIATE;
-            fseek(pPatch, 0, SEEK_END);
-            xferh.file_size = ftell(pPatch);
+        memcpy(&xferh, "0\x05Patch", 7);
+        xferh.cmd = XFER_INITIATE;
+        fseek(pPatch, 0, SEEK_END);
+        xferh.file_size = ftell(pPatch);
 
-            SendBuf((const char*)&xferh, sizeof(xferh));
-            return true;
-        }
+        SendBuf((const char*)&xferh, sizeof(xferh));
+        return true;
     }
     /// </ul>
+}
+
+bool AuthSession::LogonProof(ByteBuffer& input, ByteBuffer& output)
+{
+    sAuthLogonProof_C lp;
+    input.read((uint8*)&lp, sizeof(sAuthLogonProof_C));
 
     ///- Continue the SRP6 calculation based on data received from the client
     BigNumber A;
@@ -711,7 +785,7 @@ bool AuthSocket::_HandleLogonProof()
     t3.SetBinary(hash, 20);
 
     sha.Initialize();
-    sha.UpdateData(_login);
+    sha.UpdateData(login);
     sha.Finalize();
     uint8 t4[SHA_DIGEST_LENGTH];
     memcpy(t4, sha.GetDigest(), SHA_DIGEST_LENGTH);
@@ -727,37 +801,37 @@ bool AuthSocket::_HandleLogonProof()
     ///- Check if SRP6 results match (password is correct), else send an error
     if (!memcmp(M.AsByteArray(), lp.M1, 20))
     {
-        sLog.outBasic("User '%s' successfully authenticated", _login.c_str());
+        sLog.outBasic("User '%s' successfully authenticated", login.c_str());
 
         ///- Update the sessionkey, last_ip, last login time and reset number of failed logins in the account table for this account
         // No SQL injection (escaped user name) and IP address as received by socket
         const char* K_hex = K.AsHexStr();
-        loginDatabase.PExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', failed_logins = 0 WHERE username = '%s'", K_hex, GetRemoteAddress().c_str(), GetLocaleByName(_localizationName), _safelogin.c_str() );
+        loginDatabase.PExecute("UPDATE account SET sessionkey = '%s', last_ip = '%s', last_login = NOW(), locale = '%u', failed_logins = 0 WHERE username = '%s'", K_hex, remoteAddress.c_str(), GetLocaleByName(localizationName), safelogin.c_str() );
         OPENSSL_free((void*)K_hex);
 
         ///- Finish SRP6 and send the final result to the client
         sha.Initialize();
         sha.UpdateBigNumbers(&A, &M, &K, NULL);
         sha.Finalize();
-        
-        SendProof(sha);
 
-        ///- Set _authed to true!
-        _authed = true;
+        SendProof(output, sha);
+
+        ///- Set authed to true!
+        authed = true;
     }
     else
     {
-        char data[4]= { AUTH_LOGON_PROOF, REALM_AUTH_NO_MATCH, 3, 0};
-        SendBuf(data, sizeof(data));
-        sLog.outBasic("[AuthChallenge] account %s tried to login with wrong password!",_login.c_str ());
+        uint8 data[4]= { AUTH_LOGON_PROOF, REALM_AUTH_NO_MATCH, 3, 0};
+        output.append(data, sizeof(data));
+        sLog.outBasic("[AuthChallenge] account %s tried to login with wrong password!",login.c_str ());
 
         uint32 MaxWrongPassCount = sConfig.GetIntDefault("WrongPass.MaxCount", 0);
         if(MaxWrongPassCount > 0)
         {
             //Increment number of failed logins by one and if it reaches the limit temporarily ban that account or IP
-            loginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'",_safelogin.c_str());
+            loginDatabase.PExecute("UPDATE account SET failed_logins = failed_logins + 1 WHERE username = '%s'",safelogin.c_str());
 
-            if(QueryResult *loginfail = loginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", _safelogin.c_str()))
+            if(QueryResult *loginfail = loginDatabase.PQuery("SELECT id, failed_logins FROM account WHERE username = '%s'", safelogin.c_str()))
             {
                 Field* fields = loginfail->Fetch();
                 uint32 failed_logins = fields[1].GetUInt32();
@@ -773,16 +847,16 @@ bool AuthSocket::_HandleLogonProof()
                         loginDatabase.PExecute("INSERT INTO account_banned VALUES ('%u',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban',1)",
                             acc_id, WrongPassBanTime);
                         sLog.outBasic("[AuthChallenge] account %s got banned for '%u' seconds because it failed to authenticate '%u' times",
-                            _login.c_str(), WrongPassBanTime, failed_logins);
+                            login.c_str(), WrongPassBanTime, failed_logins);
                     }
                     else
                     {
-                        std::string current_ip = GetRemoteAddress();
+                        std::string current_ip = remoteAddress;
                         loginDatabase.escape_string(current_ip);
                         loginDatabase.PExecute("INSERT INTO ip_banned VALUES ('%s',UNIX_TIMESTAMP(),UNIX_TIMESTAMP()+'%u','MaNGOS realmd','Failed login autoban')",
                             current_ip.c_str(), WrongPassBanTime);
                         sLog.outBasic("[AuthChallenge] IP %s got banned for '%u' seconds because account %s failed to authenticate '%u' times",
-                            current_ip.c_str(), WrongPassBanTime, _login.c_str(), failed_logins);
+                            current_ip.c_str(), WrongPassBanTime, login.c_str(), failed_logins);
                     }
                 }
                 delete loginfail;
@@ -796,58 +870,49 @@ bool AuthSocket::_HandleLogonProof()
 bool AuthSocket::_HandleReconnectChallenge()
 {
     DEBUG_LOG("Entering _HandleReconnectChallenge");
-    if (ibuf.GetLength() < sizeof(sAuthLogonChallenge_C))
-        return false;
-
-    ///- Read the first 4 bytes (header) to get the length of the remaining of the packet
-    std::vector<uint8> buf;
-    buf.resize(4);
 
-    ibuf.Read((char *)&buf[0], 4);
-
-    EndianConvert(*((uint16*)(buf[0])));
-    uint16 remaining = ((sAuthLogonChallenge_C *)&buf[0])->size;
-    DEBUG_LOG("[ReconnectChallenge] got header, body is %#04x bytes", remaining);
-
-    if ((remaining < sizeof(sAuthLogonChallenge_C) - buf.size()) || (ibuf.GetLength() < remaining))
+    size_t size = GetChallengeSize();
+    if (!size)
         return false;
 
+    QueueRequest(&AuthSession::ReconnectChallenge, size);
+    return true;
+}
+
+bool AuthSession::ReconnectChallenge(ByteBuffer& input, ByteBuffer& output)
+{
     //No big fear of memory outage (size is int16, i.e. < 65536)
-    buf.resize(remaining + buf.size() + 1);
-    buf[buf.size() - 1] = 0;
+    std::vector<uint8> buf(input.contents(), input.contents() + input.size());
+    buf.push_back(0);
     sAuthLogonChallenge_C *ch = (sAuthLogonChallenge_C*)&buf[0];
 
-    ///- Read the remaining of the packet
-    ibuf.Read((char *)&buf[4], remaining);
-    DEBUG_LOG("[ReconnectChallenge] got full packet, %#04x bytes", ch->size);
+    DEBUG_LOG("[ReconnectChallenge] got full packet, %#04x bytes", input.size() - 4);
     DEBUG_LOG("[ReconnectChallenge] name(%d): '%s'", ch->I_len, ch->I);
 
-    _login = (const char*)ch->I;
-    _safelogin = _login;
-    loginDatabase.escape_string(_safelogin);
+    login = (const char*)ch->I;
+    safelogin = login;
+    loginDatabase.escape_string(safelogin);
 
-    QueryResult *result = loginDatabase.PQuery ("SELECT sessionkey FROM account WHERE username = '%s'", _safelogin.c_str ());
+    QueryResult *result = loginDatabase.PQuery ("SELECT sessionkey, id FROM account WHERE username = '%s'", safelogin.c_str ());
 
     // Stop if the account is not found
     if (!result)
     {
-        sLog.outError("[ERROR] user %s tried to login and we cannot find his session key in the database.", _login.c_str());
-        SetCloseAndDelete();
+        sLog.outError("[ERROR] user %s tried to login and we cannot find his session key in the database.", login.c_str());
         return false;
     }
 
     Field* fields = result->Fetch ();
     K.SetHexStr (fields[0].GetString ());
+    accountId = fields[1].GetUInt32 ();
     delete result;
 
     ///- Sending response
-    ByteBuffer pkt;
-    pkt << (uint8)  AUTH_RECONNECT_CHALLENGE;
-    pkt << (uint8)  0x00;
-    _reconnectProof.SetRand(16 * 8);
-    pkt.append(_reconnectProof.AsByteArray(16),16);         // 16 bytes random
-    pkt << (uint64) 0x00 << (uint64) 0x00;                  // 16 bytes zeros
-    SendBuf((char const*)pkt.contents(), pkt.size());
+    output << (uint8)  AUTH_RECONNECT_CHALLENGE;
+    output << (uint8)  0x00;
+    reconnectProof.SetRand(16 * 8);
+    output.append(reconnectProof.AsByteArray(16),16);       // 16 bytes random
+    output << (uint64) 0x00 << (uint64) 0x00;               // 16 bytes zeros
     return true;
 }
 
@@ -858,7 +923,7 @@ bool AuthSocket::_HandleReconnectProof()
     ///- Read the packet
     if (ibuf.GetLength() < sizeof(sAuthReconnectProof_C))
         return false;
-    if (_login.empty() || !_reconnectProof.GetNumBytes() || !K.GetNumBytes())
+    if (_session.login.empty() || !_session.reconnectProof.GetNumBytes() || !_session.K.GetNumBytes())
         return false;
     sAuthReconnectProof_C lp;
     ibuf.Read((char *)&lp, sizeof(sAuthReconnectProof_C));
@@ -868,8 +933,8 @@ bool AuthSocket::_HandleReconnectProof()
 
     Sha1Hash sha;
     sha.Initialize();
-    sha.UpdateData(_login);
-    sha.UpdateBigNumbers(&t1, &_reconnectProof, &K, NULL);
+    sha.UpdateData(_session.login);
+    sha.UpdateBigNumbers(&t1, &_session.reconnectProof, &_session.K, NULL);
     sha.Finalize();
 
     if (!memcmp(sha.GetDigest(), lp.R2, SHA_DIGEST_LENGTH))
@@ -881,14 +946,14 @@ bool AuthSocket::_HandleReconnectProof()
         pkt << (uint16) 0x00;                               // 2 bytes zeros
         SendBuf((char const*)pkt.contents(), pkt.size());
 
-        ///- Set _authed to true!
-        _authed = true;
+        ///- Set authed to true!
+        _session.authed = true;
 
         return true;
     }
     else
     {
-        sLog.outError("[ERROR] user %s tried to login, but session invalid.", _login.c_str());
+        sLog.outError("[ERROR] user %s tried to login, but session invalid.", _session.login.c_str());
         SetCloseAndDelete();
         return false;
     }
@@ -901,128 +966,39 @@ bool AuthSocket::_HandleRealmList()
     if (ibuf.GetLength() < 5)
         return false;
 
-    ibuf.Remove(5);
-
-    ///- Get the user id (else close the connection)
-    // No SQL injection (escaped user name)
+    QueueRequest(&AuthSession::BuildRealmList, 5);
+    return true;
+}
 
-    QueryResult *result = loginDatabase.PQuery("SELECT id,sha_pass_hash FROM account WHERE username = '%s'",_safelogin.c_str());
-    if(!result)
+bool AuthSession::BuildRealmList(ByteBuffer& /*input*/, ByteBuffer& output)
+{
+    ///- The account id is known since the (reconnect) challenge, else close the connection
+    if (!accountId)
     {
-        sLog.outError("[ERROR] user %s tried to login and we cannot find him in the database.",_login.c_str());
-        SetCloseAndDelete();
+        sLog.outError("[ERROR] user %s tried to login and we cannot find him in the database.", login.c_str());
         return false;
     }
 
-    uint32 id = (*result)[0].GetUInt32();
-    std::string rI = (*result)[1].GetCppString();
-    delete result;
-
-    ///- Update realm list if need
-    sRealmList.UpdateIfNeed();
-
-    ///- Circle through realms in the RealmList and construct the return packet (including # of user characters in each realm)
-    ByteBuffer pkt;
-    LoadRealmlist(pkt, id);
-    
-    ByteBuffer hdr;
-    hdr << (uint8) REALM_LIST;
-    hdr << (uint16)pkt.size();
-    hdr.append(pkt);
-
-    SendBuf((char const*)hdr.contents(), hdr.size());
-
-    return true;
-}
-
-void AuthSocket::LoadRealmlist(ByteBuffer &pkt, uint32 acctid)
-{   
-    switch(_build)
+    ///- Get the characters of the account on all realms at once
+    RealmCharacterCounts counts;
+    if (QueryResult *result = loginDatabase.PQuery("SELECT realmid, numchars FROM realmcharacters WHERE acctid='%u'", accountId))
     {
-        case 5875:                                          // 1.12.1
-        case 6005:                                          // 1.12.2
+        do
         {
-            pkt << uint32(0);
-            pkt << uint8(sRealmList.size());
-            
-            for(RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
-            {
-                uint8 AmountOfCharacters;
+            Field *fields = result->Fetch();
+            counts[fields[0].GetUInt32()] = fields[1].GetUInt8();
+        } while (result->NextRow());
+        delete result;
+    }
 
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult *result = loginDatabase.PQuery( "SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i->second.m_ID, acctid);
-                if( result )
-                {
-                    Field *fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
-
-                // Show offline state for unsupported client builds
-                uint8 color = (std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end()) ? i->second.color : 2;
-                color = (i->second.allowedSecurityLevel > _accountSecurityLevel) ? 2 : color;
-
-                pkt << uint32(i->second.icon);                      // realm type
-                pkt << uint8(color);                                // if 2, then realm is offline
-                pkt << i->first;                                    // name
-                pkt << i->second.address;                           // address
-                pkt << float(i->second.populationLevel);
-                pkt << uint8(AmountOfCharacters);
-                pkt << uint8(i->second.timezone);                   // realm category
-                pkt << uint8(0x00);                                 // unk, may be realm number/id?
-            }
-            
-            pkt << uint8(0x00);
-            pkt << uint8(0x02);
-            break;
-        }
-            
-        case 8606:                                          // 2.4.3
-        case 10505:                                         // 3.2.2a
-        case 11159:                                         // 3.3.0a
-        default:                                            // and later
-        {
-            pkt << uint32(0);
-            pkt << uint16(sRealmList.size());
-            
-            for(RealmList::RealmMap::const_iterator  i = sRealmList.begin(); i != sRealmList.end(); ++i)
-            {
-                uint8 AmountOfCharacters;
+    ///- Copy the cached realm list for our client build and fill in the character counts
+    ByteBuffer pkt;
+    sRealmList.BuildRealmListPacket(pkt, build, accountSecurityLevel, counts);
 
-                // No SQL injection. id of realm is controlled by the database.
-                QueryResult *result = loginDatabase.PQuery( "SELECT numchars FROM realmcharacters WHERE realmid = '%d' AND acctid='%u'", i->second.m_ID, acctid);
-                if( result )
-                {
-                    Field *fields = result->Fetch();
-                    AmountOfCharacters = fields[0].GetUInt8();
-                    delete result;
-                }
-                else
-                    AmountOfCharacters = 0;
-
-                uint8 lock = (i->second.allowedSecurityLevel > _accountSecurityLevel) ? 1 : 0;
-
-                // Show offline state for unsupported client builds
-                uint8 color = (std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), _build) != i->second.realmbuilds.end()) ? i->second.color : 2;
-
-                pkt << uint8(i->second.icon);                       // realm type
-                pkt << uint8(lock);                                 // if 1, then realm locked
-                pkt << uint8(color);                                // if 2, then realm is offline
-                pkt << i->first;                                    // name
-                pkt << i->second.address;                           // address
-                pkt << float(i->second.populationLevel);
-                pkt << uint8(AmountOfCharacters);
-                pkt << uint8(i->second.timezone);                   // realm category
-                pkt << uint8(0x2C);                                 // unk, may be realm number/id?
-            }
-            
-            pkt << uint8(0x10);
-            pkt << uint8(0x00);
-            break;
-        }
-    }
+    output << (uint8) REALM_LIST;
+    output << (uint16)pkt.size();
+    output.append(pkt);
+    return true;
 }
 
 /// Resume patch transfer
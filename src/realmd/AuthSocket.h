@@ -34,19 +34,73 @@
 #include "Auth/Sha1.h"
 #include "ByteBuffer.h"
 
+class AuthSocket;
+
+/// SRP6 and account state of one connection
+struct AuthSession
+{
+    AuthSession();
+
+    const static int s_BYTE_SIZE = 32;
+
+    bool LogonChallenge(ByteBuffer& input, ByteBuffer& output);
+    bool LogonProof(ByteBuffer& input, ByteBuffer& output);
+    bool ReconnectChallenge(ByteBuffer& input, ByteBuffer& output);
+    bool BuildRealmList(ByteBuffer& input, ByteBuffer& output);
+
+    void SetVSFields(const std::string& rI);
+    void SendProof(ByteBuffer& output, Sha1Hash& sha);
+
+    BigNumber N, s, g, v;
+    BigNumber b, B;
+    BigNumber K;
+    BigNumber reconnectProof;
+
+    bool authed;
+
+    std::string login;
+    std::string safelogin;
+    std::string remoteAddress;                              ///< as reported by the socket, not escaped
+
+    // Since GetLocaleByName() is _NOT_ bijective, we have to store the locale as a string. Otherwise we can't differ
+    // between enUS and enGB, which is important for the patch system
+    std::string localizationName;
+    uint16 build;
+    uint32 accountId;
+    AccountTypes accountSecurityLevel;
+};
+
+/// Command handed from the network thread to an auth worker, see AuthWorkerPool
+struct AuthRequest
+{
+    typedef bool (AuthSession::*Handler)(ByteBuffer& input, ByteBuffer& output);
+
+    AuthRequest(AuthSocket* socket, Handler handler, AuthSession const& session)
+        : socket(socket), handler(handler), session(session), result(false) {}
+
+    /// Run the handler (worker thread), the request is the only state it touches
+    void Process() { result = (session.*handler)(input, output); }
+
+    AuthSocket* socket;                                     ///< NULL if the socket was deleted meanwhile, network thread only
+    Handler handler;
+    AuthSession session;                                    ///< socket state in, new state out
+    ByteBuffer input;                                       ///< the complete command
+    ByteBuffer output;                                      ///< reply to send
+    bool result;                                            ///< false if the connection must be closed
+};
+
 /// Handle login commands
 class AuthSocket: public TcpSocket
 {
     public:
-        const static int s_BYTE_SIZE = 32;
-
         AuthSocket(ISocketHandler& h);
         ~AuthSocket();
 
         void OnAccept();
         void OnRead();
-        void SendProof(Sha1Hash sha);
-        void LoadRealmlist(ByteBuffer &pkt, uint32 acctid);
+
+        /// Apply the result of a request finished by the auth workers
+        void OnRequestDone(AuthRequest* request);
 
         bool _HandleLogonChallenge();
         bool _HandleLogonProof();
@@ -59,29 +113,17 @@ class AuthSocket: public TcpSocket
         bool _HandleXferCancel();
         bool _HandleXferAccept();
 
-        void _SetVSFields(const std::string& rI);
-
         FILE *pPatch;
         ACE_Thread_Mutex patcherLock;
         bool IsLag();
 
     private:
+        void ProcessInput();
+        size_t GetChallengeSize();
+        void QueueRequest(AuthRequest::Handler handler, size_t size);
 
-        BigNumber N, s, g, v;
-        BigNumber b, B;
-        BigNumber K;
-        BigNumber _reconnectProof;
-
-        bool _authed;
-
-        std::string _login;
-        std::string _safelogin;
-
-        // Since GetLocaleByName() is _NOT_ bijective, we have to store the locale as a string. Otherwise we can't differ
-        // between enUS and enGB, which is important for the patch system
-        std::string _localizationName;
-        uint16 _build;
-        AccountTypes _accountSecurityLevel;
+        AuthSession _session;
+        AuthRequest* _pendingRequest;                       ///< command in work, no further input is read until it is done
 };
 #endif
 /// @}
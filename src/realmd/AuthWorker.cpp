@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/** \file
+    \ingroup realmd
+*/
+
+#include "AuthWorker.h"
+#include "AuthSocket.h"
+#include "Database/DatabaseEnv.h"
+#include "Log.h"
+#include "Policies/SingletonImp.h"
+#include "sockets/UdpSocket.h"
+#include <ace/Atomic_Op.h>
+#include <openssl/crypto.h>
+
+INSTANTIATE_SINGLETON_1( AuthWorkerPool );
+
+extern DatabaseType loginDatabase;
+
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+// BigNumber random numbers and SRP6 math now run in several threads at once
+static ACE_Thread_Mutex* sslLocks = NULL;
+
+static void SslLockingCallback(int mode, int n, const char* /*file*/, int /*line*/)
+{
+    if (mode & CRYPTO_LOCK)
+        sslLocks[n].acquire();
+    else
+        sslLocks[n].release();
+}
+
+static unsigned long SslThreadId()
+{
+    return (unsigned long)ACE_Based::Thread::currentId();
+}
+#endif
+
+/// Loopback datagram socket connected to itself, makes the network thread's select return when requests are done
+class AuthWakeupSocket : public UdpSocket
+{
+    public:
+        explicit AuthWakeupSocket(ISocketHandler& h) : UdpSocket(h, 16), m_signalled(0) {}
+
+        /// Bind to a free loopback port and connect to it (network thread)
+        bool Setup()
+        {
+            port_t port = 0;
+            if (Bind("127.0.0.1", port) != 0)
+                return false;
+
+            struct sockaddr_in sa;
+            socklen_t len = sizeof(sa);
+            if (getsockname(GetSocket(), (struct sockaddr*)&sa, &len) != 0)
+                return false;
+
+            return UdpSocket::Open("127.0.0.1", ntohs(sa.sin_port));
+        }
+
+        /// Wake up the network thread (any thread), one datagram until it was received
+        void Signal()
+        {
+            if (m_signalled.value())
+                return;
+
+            m_signalled = 1;
+            char data = 0;
+            send(GetSocket(), &data, 1, 0);
+        }
+
+        void OnRawData(const char* /*buf*/, size_t /*len*/, struct sockaddr* /*sa*/, socklen_t /*sa_len*/)
+        {
+            // requests done after this get a new signal, all before are delivered by the next AuthWorkerPool::Update
+            m_signalled = 0;
+        }
+
+    private:
+        ACE_Atomic_Op<ACE_Thread_Mutex, long> m_signalled;
+};
+
+/// Worker thread loop
+class AuthWorkerThread : public ACE_Based::Runnable
+{
+    public:
+        explicit AuthWorkerThread(AuthWorkerPool& pool) : m_pool(pool) {}
+
+        void run()
+        {
+            loginDatabase.ThreadStart();
+
+            while (AuthRequest* request = m_pool.WaitRequest())
+            {
+                request->Process();
+                m_pool.Done(request);
+            }
+
+            loginDatabase.ThreadEnd();
+        }
+
+    private:
+        AuthWorkerPool& m_pool;
+};
+
+AuthWorkerPool::AuthWorkerPool() : m_requestsCond(m_requestsLock), m_wakeup(NULL), m_running(false)
+{
+}
+
+AuthWorkerPool::~AuthWorkerPool()
+{
+    Stop();
+
+    // the sockets are gone by now, requests left over are never delivered
+    for (std::deque<AuthRequest*>::const_iterator itr = m_requests.begin(); itr != m_requests.end(); ++itr)
+        delete *itr;
+
+    AuthRequest* request;
+    while (m_done.next(request))
+        delete request;
+}
+
+void AuthWorkerPool::Start(ISocketHandler& h, uint32 threads)
+{
+    if (!threads)
+    {
+        sLog.outString("Auth requests processed in the network thread");
+        return;
+    }
+
+    #if OPENSSL_VERSION_NUMBER < 0x10100000L
+    if (!sslLocks)
+    {
+        sslLocks = new ACE_Thread_Mutex[CRYPTO_num_locks()];
+        CRYPTO_set_id_callback(SslThreadId);
+        CRYPTO_set_locking_callback(SslLockingCallback);
+    }
+    #endif
+
+    m_wakeup = new AuthWakeupSocket(h);
+    if (!m_wakeup->Setup())
+    {
+        sLog.outError("Can't create the auth worker wakeup socket, finished requests wait for the next select timeout");
+        delete m_wakeup;
+        m_wakeup = NULL;
+    }
+    else
+    {
+        m_wakeup->SetDeleteByHandler();
+        h.Add(m_wakeup);
+    }
+
+    m_running = true;
+
+    for (uint32 i = 0; i < threads; ++i)
+        m_threads.push_back(new ACE_Based::Thread(new AuthWorkerThread(*this)));
+
+    sLog.outString("Started %u auth worker threads", threads);
+}
+
+void AuthWorkerPool::Stop()
+{
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_requestsLock);
+        m_running = false;
+        m_requestsCond.broadcast();
+    }
+
+    for (ThreadList::const_iterator itr = m_threads.begin(); itr != m_threads.end(); ++itr)
+    {
+        (*itr)->wait();
+        delete *itr;
+    }
+    m_threads.clear();
+
+    // deleted by the socket handler
+    m_wakeup = NULL;
+}
+
+AuthRequest* AuthWorkerPool::WaitRequest()
+{
+    ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, m_requestsLock, NULL);
+
+    while (m_running && m_requests.empty())
+        m_requestsCond.wait();
+
+    if (!m_running)
+        return NULL;
+
+    AuthRequest* request = m_requests.front();
+    m_requests.pop_front();
+    return request;
+}
+
+void AuthWorkerPool::Done(AuthRequest* request)
+{
+    m_done.add(request);
+
+    if (m_wakeup)
+        m_wakeup->Signal();
+}
+
+void AuthWorkerPool::Schedule(AuthRequest* request)
+{
+    if (m_threads.empty())
+    {
+        request->Process();
+        m_done.add(request);
+    }
+    else
+    {
+        ACE_GUARD(ACE_Thread_Mutex, guard, m_requestsLock);
+        m_requests.push_back(request);
+        m_requestsCond.signal();
+    }
+}
+
+void AuthWorkerPool::Update()
+{
+    AuthRequest* request;
+    while (m_done.next(request))
+    {
+        if (request->socket)
+            request->socket->OnRequestDone(request);
+
+        delete request;
+    }
+}
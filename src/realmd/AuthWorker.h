@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/// \addtogroup realmd
+/// @{
+/// \file
+
+#ifndef _AUTHWORKER_H
+#define _AUTHWORKER_H
+
+#include "Common.h"
+#include "LockedQueue.h"
+#include "Threading.h"
+#include "Policies/Singleton.h"
+#include <ace/Thread_Mutex.h>
+#include <ace/Condition_Thread_Mutex.h>
+#include <deque>
+
+struct AuthRequest;
+class AuthWakeupSocket;
+class ISocketHandler;
+
+/**
+ * Threads running the database lookups and SRP6 math of the auth commands.
+ *
+ * The network thread only parses commands and sends replies, so a slow
+ * query or a burst of logons after a world server crash does not stall
+ * every other connection. Idle workers wait on a condition, finished
+ * requests wake the network thread's select through a loopback socket and
+ * are handed back to it, the client sockets are never touched by the workers.
+ */
+class AuthWorkerPool
+{
+    public:
+        AuthWorkerPool();
+        ~AuthWorkerPool();
+
+        /// Start the worker threads, without threads requests are processed in the network thread
+        void Start(ISocketHandler& h, uint32 threads);
+        void Stop();
+
+        /// Hand a request to the workers (network thread)
+        void Schedule(AuthRequest* request);
+
+        /// Deliver the finished requests to their sockets (network thread)
+        void Update();
+
+    private:
+        friend class AuthWorkerThread;
+
+        /// Next request for a worker, blocks until there is one, NULL at stop (worker thread)
+        AuthRequest* WaitRequest();
+        /// Hand a processed request back to the network thread (worker thread)
+        void Done(AuthRequest* request);
+
+        typedef ACE_Based::LockedQueue<AuthRequest*, ACE_Thread_Mutex> RequestQueue;
+        typedef std::vector<ACE_Based::Thread*> ThreadList;
+
+        std::deque<AuthRequest*> m_requests;                ///< waiting for a worker
+        ACE_Thread_Mutex m_requestsLock;
+        ACE_Condition_Thread_Mutex m_requestsCond;          ///< signalled at new request and at stop
+        RequestQueue m_done;                                ///< waiting for the network thread
+        AuthWakeupSocket* m_wakeup;                         ///< owned by the socket handler
+        ThreadList m_threads;
+        bool m_running;                                     ///< guarded by m_requestsLock
+};
+
+#define sAuthWorkerPool MaNGOS::Singleton<AuthWorkerPool>::Instance()
+
+#endif
+/// @}
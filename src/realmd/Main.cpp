@@ -28,6 +28,7 @@
 #include "Log.h"
 #include "sockets/ListenSocket.h"
 #include "AuthSocket.h"
+#include "AuthWorker.h"
 #include "SystemConfig.h"
 #include "revision.h"
 #include "revision_nr.h"
@@ -216,6 +217,9 @@ extern int main(int argc, char **argv)
 
     h.Add(&authListenSocket);
 
+    ///- Start the threads for database lookups and SRP6 math
+    sAuthWorkerPool.Start(h, sConfig.GetIntDefault("AuthWorkerThreads", 2));
+
     ///- Catch termination signals
     HookSignals();
 
@@ -262,19 +266,24 @@ extern int main(int argc, char **argv)
     }
     #endif
 
-    // maximum counter for next ping
-    uint32 numLoops = (sConfig.GetIntDefault( "MaxPingTime", 30 ) * (MINUTE * 1000000 / 100000));
-    uint32 loopCounter = 0;
+    // time of the next ping
+    uint32 pingInterval = sConfig.GetIntDefault( "MaxPingTime", 30 ) * MINUTE;
+    time_t nextPingTime = time(NULL) + pingInterval;
 
     ///- Wait for termination signal
     while (!stopEvent)
     {
-
+        // finished auth requests wake up the select
         h.Select(0, 100000);
 
-        if( (++loopCounter) == numLoops )
+        sAuthWorkerPool.Update();
+
+        ///- Refresh the realm list (and drop the serialized lists) if its time has come
+        sRealmList.UpdateIfNeed();
+
+        if (time(NULL) >= nextPingTime)
         {
-            loopCounter = 0;
+            nextPingTime = time(NULL) + pingInterval;
             sLog.outDetail("Ping MySQL to keep connection alive");
             delete loginDatabase.Query("SELECT 1 FROM realmlist LIMIT 1");
         }
@@ -284,6 +293,9 @@ extern int main(int argc, char **argv)
 #endif
     }
 
+    ///- Wait for the auth workers to exit
+    sAuthWorkerPool.Stop();
+
     ///- Wait for the delay thread to exit
     loginDatabase.HaltDelayThread();
 
@@ -26,6 +26,7 @@
 #include "Util.h"                                           // for Tokens typedef
 #include "Policies/SingletonImp.h"
 #include "Database/DatabaseEnv.h"
+#include <ace/Guard_T.h>
 
 INSTANTIATE_SINGLETON_1( RealmList );
 
@@ -50,10 +51,10 @@ void RealmList::Initialize(uint32 updateInterval)
     UpdateRealms(true);
 }
 
-void RealmList::UpdateRealm( uint32 ID, const std::string& name, const std::string& address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, const char* builds)
+void RealmList::UpdateRealm(RealmMap& realms, uint32 ID, const std::string& name, const std::string& address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, const char* builds)
 {      
     ///- Create new if not exist or update existed
-    Realm& realm = m_realms[name];
+    Realm& realm = realms[name];
     
     realm.m_ID      = ID;
     realm.icon      = icon;
@@ -85,9 +86,6 @@ void RealmList::UpdateIfNeed()
 
     m_NextUpdateTime = time(NULL) + m_UpdateInterval;
 
-    // Clears Realm list
-    m_realms.clear();
-
     // Get the content of the realmlist table in the database
     UpdateRealms(false);
 }
@@ -99,6 +97,8 @@ void RealmList::UpdateRealms(bool init)
     ////                                               0    1    2        3     4     5      6         7                     8           9
     QueryResult *result = loginDatabase.Query( "SELECT id, name, address, port, icon, color, timezone, allowedSecurityLevel, population, realmbuilds FROM realmlist WHERE color <> 3 ORDER BY name" );
 
+    RealmMap realms;
+
     ///- Circle through results and add them to the realm map
     if(result)
     {
@@ -108,10 +108,103 @@ void RealmList::UpdateRealms(bool init)
 
             uint8 allowedSecurityLevel = fields[7].GetUInt8();
 
-            UpdateRealm(fields[0].GetUInt32(), fields[1].GetCppString(),fields[2].GetCppString(),fields[3].GetUInt32(),fields[4].GetUInt8(), fields[5].GetUInt8(), fields[6].GetUInt8(), (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), fields[8].GetFloat(), fields[9].GetString() );
+            UpdateRealm(realms, fields[0].GetUInt32(), fields[1].GetCppString(),fields[2].GetCppString(),fields[3].GetUInt32(),fields[4].GetUInt8(), fields[5].GetUInt8(), fields[6].GetUInt8(), (allowedSecurityLevel <= SEC_ADMINISTRATOR ? AccountTypes(allowedSecurityLevel) : SEC_ADMINISTRATOR), fields[8].GetFloat(), fields[9].GetString() );
             if(init)
                 sLog.outString("Added realm \"%s\"", fields[1].GetString());
         } while( result->NextRow() );
         delete result;
     }
+
+    ///- Replace the realms and drop the serialized lists, workers may be building one right now
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+    m_realms.swap(realms);
+    m_cache.clear();
+}
+
+void RealmList::BuildRealmListPacket(ByteBuffer& pkt, uint16 build, AccountTypes security, RealmCharacterCounts const& counts)
+{
+    ACE_GUARD(ACE_Thread_Mutex, guard, m_lock);
+
+    ///- Realm state only depends on the build and account security, serialize each combination once
+    RealmListCache& cache = m_cache[(uint32(build) << 8) | uint32(security)];
+    if (cache.data.empty())
+        SerializeRealmList(cache, build, security);
+
+    size_t start = pkt.wpos();
+    pkt.append(cache.data);
+
+    for (std::vector<std::pair<uint32, size_t> >::const_iterator itr = cache.countPos.begin(); itr != cache.countPos.end(); ++itr)
+    {
+        RealmCharacterCounts::const_iterator count = counts.find(itr->first);
+        if (count != counts.end())
+            pkt.put<uint8>(start + itr->second, count->second);
+    }
+}
+
+void RealmList::SerializeRealmList(RealmListCache& cache, uint16 build, AccountTypes security) const
+{
+    ByteBuffer& pkt = cache.data;
+
+    switch(build)
+    {
+        case 5875:                                          // 1.12.1
+        case 6005:                                          // 1.12.2
+        {
+            pkt << uint32(0);
+            pkt << uint8(m_realms.size());
+
+            for(RealmMap::const_iterator i = m_realms.begin(); i != m_realms.end(); ++i)
+            {
+                // Show offline state for unsupported client builds
+                uint8 color = (std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), build) != i->second.realmbuilds.end()) ? i->second.color : 2;
+                color = (i->second.allowedSecurityLevel > security) ? 2 : color;
+
+                pkt << uint32(i->second.icon);                      // realm type
+                pkt << uint8(color);                                // if 2, then realm is offline
+                pkt << i->first;                                    // name
+                pkt << i->second.address;                           // address
+                pkt << float(i->second.populationLevel);
+                cache.countPos.push_back(std::make_pair(i->second.m_ID, pkt.wpos()));
+                pkt << uint8(0);                                    // characters, filled per account
+                pkt << uint8(i->second.timezone);                   // realm category
+                pkt << uint8(0x00);                                 // unk, may be realm number/id?
+            }
+
+            pkt << uint8(0x00);
+            pkt << uint8(0x02);
+            break;
+        }
+
+        case 8606:                                          // 2.4.3
+        case 10505:                                         // 3.2.2a
+        case 11159:                                         // 3.3.0a
+        default:                                            // and later
+        {
+            pkt << uint32(0);
+            pkt << uint16(m_realms.size());
+
+            for(RealmMap::const_iterator i = m_realms.begin(); i != m_realms.end(); ++i)
+            {
+                uint8 lock = (i->second.allowedSecurityLevel > security) ? 1 : 0;
+
+                // Show offline state for unsupported client builds
+                uint8 color = (std::find(i->second.realmbuilds.begin(), i->second.realmbuilds.end(), build) != i->second.realmbuilds.end()) ? i->second.color : 2;
+
+                pkt << uint8(i->second.icon);                       // realm type
+                pkt << uint8(lock);                                 // if 1, then realm locked
+                pkt << uint8(color);                                // if 2, then realm is offline
+                pkt << i->first;                                    // name
+                pkt << i->second.address;                           // address
+                pkt << float(i->second.populationLevel);
+                cache.countPos.push_back(std::make_pair(i->second.m_ID, pkt.wpos()));
+                pkt << uint8(0);                                    // characters, filled per account
+                pkt << uint8(i->second.timezone);                   // realm category
+                pkt << uint8(0x2C);                                 // unk, may be realm number/id?
+            }
+
+            pkt << uint8(0x10);
+            pkt << uint8(0x00);
+            break;
+        }
+    }
 }
@@ -24,6 +24,8 @@
 #define _REALMLIST_H
 
 #include "Common.h"
+#include "ByteBuffer.h"
+#include <ace/Thread_Mutex.h>
 
 /// Storage object for a realm
 struct Realm
@@ -38,6 +40,9 @@ struct Realm
     std::set<uint32> realmbuilds;
 };
 
+/// Character count of one account per realm id
+typedef std::map<uint32, uint8> RealmCharacterCounts;
+
 /// Storage object for the list of realms on the server
 class RealmList
 {
@@ -53,16 +58,29 @@ class RealmList
 
         void UpdateIfNeed();
 
-        RealmMap::const_iterator begin() const { return m_realms.begin(); }
-        RealmMap::const_iterator end() const { return m_realms.end(); }
+        /// Append the realm list body as seen by a client build and account security, can be called from any thread
+        void BuildRealmListPacket(ByteBuffer& pkt, uint16 build, AccountTypes security, RealmCharacterCounts const& counts);
+
         uint32 size() const { return m_realms.size(); }
     private:
+        /// Serialized realm list with the character count left to fill in per account
+        struct RealmListCache
+        {
+            ByteBuffer data;
+            std::vector<std::pair<uint32, size_t> > countPos;   ///< realm id and offset of its character count
+        };
+        typedef std::map<uint32, RealmListCache> RealmListCacheMap;
+
         void UpdateRealms(bool init);
-        void UpdateRealm( uint32 ID, const std::string& name, const std::string& address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, const char* builds);
+        void UpdateRealm(RealmMap& realms, uint32 ID, const std::string& name, const std::string& address, uint32 port, uint8 icon, uint8 color, uint8 timezone, AccountTypes allowedSecurityLevel, float popu, const char* builds);
+        void SerializeRealmList(RealmListCache& cache, uint16 build, AccountTypes security) const;
     private:
         RealmMap m_realms;                                  ///< Internal map of realms
         uint32   m_UpdateInterval;
         time_t   m_NextUpdateTime;
+
+        RealmListCacheMap m_cache;                          ///< Realm list per client build and security, dropped at realm update
+        ACE_Thread_Mutex m_lock;                            ///< Guards m_realms changes against workers and m_cache
 };
 
 #define sRealmList RealmList::Instance()
@@ -19,34 +19,36 @@
 #include "Auth/SARC4.h"
 #include <openssl/sha.h>
 
-SARC4::SARC4()
+SARC4::SARC4() : m_x(0), m_y(0)
 {
-    EVP_CIPHER_CTX_init(&m_ctx);
-    EVP_EncryptInit_ex(&m_ctx, EVP_rc4(), NULL, NULL, NULL);
-    EVP_CIPHER_CTX_set_key_length(&m_ctx, SHA_DIGEST_LENGTH);
+    for (int i = 0; i < 256; ++i)
+        m_state[i] = uint8(i);
 }
 
 SARC4::SARC4(uint8 *seed)
 {
-    EVP_CIPHER_CTX_init(&m_ctx);
-    EVP_EncryptInit_ex(&m_ctx, EVP_rc4(), NULL, NULL, NULL);
-    EVP_CIPHER_CTX_set_key_length(&m_ctx, SHA_DIGEST_LENGTH);
-    EVP_EncryptInit_ex(&m_ctx, NULL, NULL, seed, NULL);
+    Init(seed);
 }
 
 SARC4::~SARC4()
 {
-    EVP_CIPHER_CTX_cleanup(&m_ctx);
 }
 
 void SARC4::Init(uint8 *seed)
 {
-    EVP_EncryptInit_ex(&m_ctx, NULL, NULL, seed, NULL);
-}
+    for (int i = 0; i < 256; ++i)
+        m_state[i] = uint8(i);
 
-void SARC4::UpdateData(int len, uint8 *data)
-{
-    int outlen = 0;
-    EVP_EncryptUpdate(&m_ctx, data, &outlen, data, len);
-    EVP_EncryptFinal_ex(&m_ctx, data, &outlen);
+    // key schedule, seeds are always SHA_DIGEST_LENGTH bytes (HMAC-SHA1 of the session key)
+    uint8 j = 0;
+    for (int i = 0; i < 256; ++i)
+    {
+        uint8 t = m_state[i];
+        j += uint8(t + seed[i % SHA_DIGEST_LENGTH]);
+        m_state[i] = m_state[j];
+        m_state[j] = t;
+    }
+
+    m_x = 0;
+    m_y = 0;
 }
@@ -20,8 +20,10 @@
 #define _AUTH_SARC4_H
 
 #include "Common.h"
-#include <openssl/evp.h>
 
+/// RC4 stream cipher used for the world packet headers.
+/// Headers are 4-6 bytes long, so the keystream is generated here directly:
+/// going through EVP costs more in dispatch than the few bytes of work.
 class SARC4
 {
     public:
@@ -29,8 +31,28 @@ class SARC4
         SARC4(uint8 *seed);
         ~SARC4();
         void Init(uint8 *seed);
-        void UpdateData(int len, uint8 *data);
+        void UpdateData(int len, uint8 *data)
+        {
+            uint8 x = m_x;
+            uint8 y = m_y;
+
+            for (int i = 0; i < len; ++i)
+            {
+                ++x;
+                uint8 tx = m_state[x];
+                y += tx;
+                uint8 ty = m_state[y];
+                m_state[x] = ty;
+                m_state[y] = tx;
+                data[i] ^= m_state[uint8(tx + ty)];
+            }
+
+            m_x = x;
+            m_y = y;
+        }
     private:
-        EVP_CIPHER_CTX m_ctx;
+        uint8 m_state[256];
+        uint8 m_x;
+        uint8 m_y;
 };
 #endif
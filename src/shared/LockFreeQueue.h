@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2005-2010 MaNGOS <http://getmangos.com/>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOCKFREEQUEUE_H
+#define LOCKFREEQUEUE_H
+
+#include <ace/Atomic_Op.h>
+#include <ace/Thread_Mutex.h>
+#include "Errors.h"
+
+namespace ACE_Based
+{
+    /**
+     * Bounded single-producer/single-consumer ring.
+     *
+     * Exactly one thread may call add() and exactly one (other) thread may
+     * call next(), peek() and release(). Under that contract no lock is taken: each side owns one
+     * index and only reads the index of the other side. T is expected to be
+     * a pointer or other plain value type, it is copied in and out of the slots.
+     * The consumer role may move between threads as long as the hand over is
+     * ordered by other means (e.g. world update followed by map update).
+     */
+    template <class T>
+        class LockFreeQueue
+    {
+        typedef ACE_Atomic_Op<ACE_Thread_Mutex, unsigned long> IndexType;
+
+        //! Slots, capacity is always a power of 2.
+        T volatile* _items;
+
+        //! capacity - 1, used to wrap indexes.
+        unsigned long _mask;
+
+        //! Next slot to read, written only by the consumer.
+        IndexType _head;
+
+        //! Keep producer and consumer indexes on different cache lines.
+        char _pad[64];
+
+        //! Next slot to write, written only by the producer.
+        IndexType _tail;
+
+        // not copyable
+        LockFreeQueue(LockFreeQueue const&);
+        LockFreeQueue& operator=(LockFreeQueue const&);
+
+        public:
+
+            //! Create a LockFreeQueue able to hold at least capacity items.
+            explicit LockFreeQueue(unsigned long capacity)
+                : _head(0), _tail(0)
+            {
+                unsigned long size = 2;
+                while (size < capacity)
+                    size <<= 1;
+
+                _items = new T[size];
+                _mask = size - 1;
+            }
+
+            //! Destroy a LockFreeQueue, items still queued are not freed.
+            ~LockFreeQueue()
+            {
+                delete[] _items;
+            }
+
+            //! Adds an item to the queue (producer side).
+            //! Returns false if the queue is full.
+            bool add(const T& item)
+            {
+                unsigned long tail = _tail.value();
+
+                if (tail - _head.value() > _mask)
+                    return false;
+
+                _items[tail & _mask] = item;
+
+                // publish the slot only after it is written
+                _tail = tail + 1;
+                return true;
+            }
+
+            //! Gets the next item in the queue, if any (consumer side).
+            bool next(T& result)
+            {
+                unsigned long head = _head.value();
+
+                if (head == _tail.value())
+                    return false;
+
+                result = _items[head & _mask];
+
+                // release the slot only after it is read
+                _head = head + 1;
+                return true;
+            }
+
+            //! Copies up to max items from the front of the queue without
+            //! removing them (consumer side). Returns the number of items copied.
+            unsigned long peek(T* result, unsigned long max) const
+            {
+                unsigned long head = _head.value();
+                unsigned long count = _tail.value() - head;
+
+                if (count > max)
+                    count = max;
+
+                for (unsigned long i = 0; i < count; ++i)
+                    result[i] = _items[(head + i) & _mask];
+
+                return count;
+            }
+
+            //! Removes count items previously returned by peek() (consumer side).
+            void release(unsigned long count)
+            {
+                if (!count)
+                    return;
+
+                ASSERT(count <= size());
+
+                _head = _head.value() + count;
+            }
+
+            //! Number of queued items, exact only when called from one of the two sides.
+            unsigned long size() const
+            {
+                return _tail.value() - _head.value();
+            }
+
+            //! Number of items the queue can hold.
+            unsigned long capacity() const
+            {
+                return _mask + 1;
+            }
+
+            bool empty() const
+            {
+                return size() == 0;
+            }
+    };
+}
+#endif
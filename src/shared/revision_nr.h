@@ -1,4 +1,4 @@
 #ifndef __REVISION_NR_H__
 #define __REVISION_NR_H__
- #define REVISION_NR "9162"
+ #define REVISION_NR "9201"
 #endif // __REVISION_NR_H__
@@ -1,6 +1,6 @@
 #ifndef __REVISION_SQL_H__
 #define __REVISION_SQL_H__
  #define REVISION_DB_CHARACTERS "required_9136_07_characters_characters"
- #define REVISION_DB_MANGOS "required_9160_02_mangos_spell_chain"
+ #define REVISION_DB_MANGOS "required_9178_01_mangos_command"
  #define REVISION_DB_REALMD "required_9010_01_realmd_realmlist"
 #endif // __REVISION_SQL_H__
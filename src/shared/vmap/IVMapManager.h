@@ -60,6 +60,10 @@ namespace VMAP
             virtual void unloadMap(unsigned int pMapId) = 0;
 
             virtual bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) = 0;
+            /**
+            test pCount targets against one origin, pTargets holds x,y,z of each target and pResults gets one value per target
+            */
+            virtual void isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, const float* pTargets, unsigned int pCount, bool* pResults) = 0;
             virtual float getHeight(unsigned int pMapId, float x, float y, float z) = 0;
             /**
             test if we hit an object. return true if we hit one. rx,ry,rz will hold the hit position or the dest position, if no intersection was found
@@ -86,6 +90,17 @@ namespace VMAP
             bool isHeightCalcEnabled() const { return(iEnableHeightCalc); }
             bool isMapLoadingEnabled() const { return(iEnableLineOfSightCalc || iEnableHeightCalc  ); }
 
+            /**
+            Keep line of sight results for pTime milliseconds, 0 disables the cache
+            */
+            virtual void setLineOfSightCacheTime(unsigned int pTime) = 0;
+            /**
+            Call while no map is updated: advances the line of sight cache clock (results expire only by this clock)
+            and frees the data replaced by loads and unloads since the last call
+            */
+            virtual void update(unsigned int pDiff) = 0;
+            virtual void getLineOfSightCacheStats(unsigned long long& pHits, unsigned long long& pMisses) = 0;
+
             virtual std::string getDirFileName(unsigned int pMapId, int x, int y) const =0;
             /**
             Block maps from being used.
@@ -39,7 +39,7 @@ namespace VMAP
     //==========================================================
 
     ModelContainer::ModelContainer(unsigned int pNTriangles, unsigned int pNNodes, unsigned int pNSubModel) :
-    BaseModel(pNNodes, pNTriangles)
+    BaseModel(pNNodes, pNTriangles), iFlatNodes(0), iNFlatNodes(0), iFlatRoot(FLAT_TREE_NONE), iSubModelFlatRoots(0)
     {
 
         iNSubModel = pNSubModel;
@@ -149,7 +149,8 @@ namespace VMAP
     Create the structure out of a AABSPTree
     */
 
-    ModelContainer::ModelContainer(AABSPTree<SubModel *> *pTree)
+    ModelContainer::ModelContainer(AABSPTree<SubModel *> *pTree) :
+    iFlatNodes(0), iNFlatNodes(0), iFlatRoot(FLAT_TREE_NONE), iSubModelFlatRoots(0)
     {
 
         int nSubModels, nNodes, nTriangles;
@@ -179,6 +180,7 @@ namespace VMAP
 
     ModelContainer::~ModelContainer(void)
     {
+        freeFlatTree();
         free();
         if(iSubModel != 0) delete [] iSubModel;
     }
@@ -251,6 +253,7 @@ namespace VMAP
         FILE *rf = fopen(filename, "rb");
         if(rf)
         {
+            freeFlatTree();
             free();
 
             result = true;
@@ -311,16 +314,186 @@ namespace VMAP
                 }
             }
             fclose(rf);
+
+            if(result)
+                buildFlatTree();
         }
         return result;
     }
 
+    //=================================================================
+    /**
+    Helpers to convert the TreeNodes into FlatTreeNodes
+    */
+    namespace
+    {
+        void setFlatBounds(FlatTreeNode& pNode, const AABox& pBox)
+        {
+            for(int i=0; i<3; ++i)
+            {
+                pNode.iLow[i] = pBox.low()[i];
+                pNode.iHigh[i] = pBox.high()[i];
+            }
+        }
+
+        void mergeBounds(AABox& pBox, const AABox& pOther)
+        {
+            pBox.set(pBox.low().min(pOther.low()), pBox.high().max(pOther.high()));
+        }
+
+        AABox getNodeBounds(const TreeNode& pNode)
+        {
+            AABox box;
+            pNode.getBounds(box);
+            return box;
+        }
+
+        template<class TValue>
+        class FlatTreeBuilder
+        {
+            private:
+                Array<FlatTreeNode>& iOut;
+                const TreeNode* iNodes;
+                const TValue* iValues;
+            public:
+                unsigned int iMaxDepth;
+
+                FlatTreeBuilder(Array<FlatTreeNode>& pOut, const TreeNode* pNodes, const TValue* pValues) :
+                    iOut(pOut), iNodes(pNodes), iValues(pValues), iMaxDepth(0) {}
+
+                unsigned int addNode(const AABox& pBox, unsigned int pOffset, unsigned int pCount, unsigned int pDepth)
+                {
+                    if(pDepth > iMaxDepth)
+                        iMaxDepth = pDepth;
+
+                    FlatTreeNode node;
+                    setFlatBounds(node, pBox);
+                    node.iOffset = pOffset;
+                    node.iCount = pCount;
+                    iOut.append(node);
+                    return(iOut.size() - 1);
+                }
+
+                unsigned int addValues(const TreeNode& pNode, unsigned int pDepth)
+                {
+                    unsigned int start = pNode.getStartPosition();
+                    AABox box = iValues[start].getAABoxBounds();
+                    for(unsigned int i = start + 1; i < start + pNode.getNValues(); ++i)
+                        mergeBounds(box, iValues[i].getAABoxBounds());
+                    return addNode(box, start, pNode.getNValues(), pDepth);
+                }
+
+                // the first child has to be the next node, so it is added right after the parent
+                unsigned int addPair(const AABox& pBox, const TreeNode& pFirst, const TreeNode& pSecond, unsigned int pDepth)
+                {
+                    unsigned int pos = addNode(pBox, 0, FLAT_TREE_INNER, pDepth);
+                    add(pFirst, pDepth + 1);
+                    unsigned int second = add(pSecond, pDepth + 1);
+                    iOut[pos].iOffset = second;
+                    return pos;
+                }
+
+                // a TreeNode holding values and children becomes an inner node with a leaf and the children below
+                unsigned int add(const TreeNode& pNode, unsigned int pDepth)
+                {
+                    const TreeNode* left = pNode.getChild(iNodes, 0);
+                    const TreeNode* right = pNode.getChild(iNodes, 1);
+
+                    if(!left && !right)
+                        return addNode(getNodeBounds(pNode), pNode.getStartPosition(), pNode.getNValues(), pDepth);
+
+                    if(pNode.getNValues() == 0)
+                    {
+                        if(!right)
+                            return add(*left, pDepth);
+                        if(!left)
+                            return add(*right, pDepth);
+                        return addPair(getNodeBounds(pNode), *left, *right, pDepth);
+                    }
+
+                    unsigned int pos = addNode(getNodeBounds(pNode), 0, FLAT_TREE_INNER, pDepth);
+                    addValues(pNode, pDepth + 1);
+
+                    unsigned int second;
+                    if(left && right)
+                    {
+                        AABox box = getNodeBounds(*left);
+                        mergeBounds(box, getNodeBounds(*right));
+                        second = addPair(box, *left, *right, pDepth + 1);
+                    }
+                    else
+                        second = add(left ? *left : *right, pDepth + 1);
+
+                    iOut[pos].iOffset = second;
+                    return pos;
+                }
+        };
+    }
+
+    //=================================================================
+
+    void ModelContainer::buildFlatTree()
+    {
+        freeFlatTree();
+
+        if(getNNodes() == 0)
+            return;
+
+        Array<FlatTreeNode> nodes;
+        unsigned int maxDepth = 0;
+        iSubModelFlatRoots = new unsigned int[iNSubModel];
+
+        for(unsigned int i=0; i<iNSubModel; ++i)
+        {
+            const SubModel& sm = iSubModel[i];
+            if(sm.getNNodes() == 0)
+            {
+                iSubModelFlatRoots[i] = FLAT_TREE_NONE;
+                continue;
+            }
+
+            FlatTreeBuilder<TriangleBox> builder(nodes, sm.getTreeNodes(), sm.getTriangles());
+            iSubModelFlatRoots[i] = builder.add(sm.getTreeNode(0), 0);
+            if(builder.iMaxDepth > maxDepth)
+                maxDepth = builder.iMaxDepth;
+        }
+
+        FlatTreeBuilder<SubModel> builder(nodes, getTreeNodes(), iSubModel);
+        iFlatRoot = builder.add(getTreeNode(0), 0);
+        if(builder.iMaxDepth > maxDepth)
+            maxDepth = builder.iMaxDepth;
+
+        // unusual deep trees are walked the old way
+        if(maxDepth >= FLAT_TREE_MAX_DEPTH)
+        {
+            freeFlatTree();
+            return;
+        }
+
+        iNFlatNodes = nodes.size();
+        iFlatNodes = new FlatTreeNode[iNFlatNodes];
+        memcpy(iFlatNodes, nodes.getCArray(), sizeof(FlatTreeNode) * iNFlatNodes);
+    }
+
+    //=================================================================
+
+    void ModelContainer::freeFlatTree()
+    {
+        delete [] iFlatNodes;
+        delete [] iSubModelFlatRoots;
+        iFlatNodes = 0;
+        iSubModelFlatRoots = 0;
+        iNFlatNodes = 0;
+        iFlatRoot = FLAT_TREE_NONE;
+    }
+
     //=================================================================
 
     size_t ModelContainer::getMemUsage()
     {
                                                             // BaseModel is included in ModelContainer
-        return(iNSubModel * sizeof(SubModel) + BaseModel::getMemUsage() + sizeof(ModelContainer) - sizeof(BaseModel));
+        size_t flatSize = iNFlatNodes * sizeof(FlatTreeNode) + (iSubModelFlatRoots ? iNSubModel * sizeof(unsigned int) : 0);
+        return(iNSubModel * sizeof(SubModel) + flatSize + BaseModel::getMemUsage() + sizeof(ModelContainer) - sizeof(BaseModel));
     }
 
     //=================================================================
@@ -333,8 +506,193 @@ namespace VMAP
 #endif
 #endif
 
+    namespace
+    {
+        /**
+        Ray prepared for the slab tests, zero direction components get a huge inverse instead of inf
+        so no 0*inf can happen.
+        */
+        struct FlatRay
+        {
+            Vector3 iOrigin;
+            Vector3 iDirection;
+            Vector3 iInvDirection;
+
+            FlatRay(const Vector3& pOrigin, const Vector3& pDirection) : iOrigin(pOrigin), iDirection(pDirection)
+            {
+                for(int i=0; i<3; ++i)
+                    iInvDirection[i] = pDirection[i] != 0.0f ? 1.0f / pDirection[i] : 1e30f;
+            }
+        };
+
+        /**
+        Two sided version of the Moller-Trumbore test used by G3D::Ray, so one call replaces
+        the two G3D::Triangle based tests of TriangleBox::intersect().
+        */
+        inline float intersectTriangle(const FlatRay& pRay, const TriangleBox& pTriangle)
+        {
+            const Vector3 v0 = pTriangle.vertex(0).getVector3();
+            const Vector3 edge1 = pTriangle.vertex(1).getVector3() - v0;
+            const Vector3 edge2 = pTriangle.vertex(2).getVector3() - v0;
+
+            const Vector3 pvec = pRay.iDirection.cross(edge2);
+            const float det = edge1.dot(pvec);
+            if(det > -0.000001f && det < 0.000001f)
+                return(inf());
+
+            const float invDet = 1.0f / det;
+            const Vector3 tvec = pRay.iOrigin - v0;
+            const float u = tvec.dot(pvec) * invDet;
+            if(u < 0.0f || u > 1.0f)
+                return(inf());
+
+            const Vector3 qvec = tvec.cross(edge1);
+            const float v = pRay.iDirection.dot(qvec) * invDet;
+            if(v < 0.0f || u + v > 1.0f)
+                return(inf());
+
+            const float t = edge2.dot(qvec) * invDet;
+            return(t >= 0.0f ? t : inf());
+        }
+
+        /**
+        Walk a flat tree front to back. pLeaf is called for each leaf the ray enters closer than pMaxDist
+        and returns true to stop the walk.
+        */
+        template<class TLeaf>
+        bool walkFlatTree(const FlatTreeNode* pNodes, unsigned int pRoot, const FlatRay& pRay, float& pMaxDist, TLeaf& pLeaf)
+        {
+            struct StackEntry
+            {
+                unsigned int iNode;
+                float iDist;
+            };
+            StackEntry stack[FLAT_TREE_MAX_DEPTH];
+            int stackSize = 0;
+
+            if(!(pNodes[pRoot].intersect(pRay.iOrigin, pRay.iInvDirection, pMaxDist) < inf()))
+                return false;
+
+            unsigned int pos = pRoot;
+            for(;;)
+            {
+                const FlatTreeNode& node = pNodes[pos];
+                if(node.isLeaf())
+                {
+                    if(node.iCount && pLeaf(node.iOffset, node.iCount, pRay, pMaxDist))
+                        return true;
+                }
+                else
+                {
+                    unsigned int first = pos + 1;
+                    unsigned int second = node.iOffset;
+                    float firstDist = pNodes[first].intersect(pRay.iOrigin, pRay.iInvDirection, pMaxDist);
+                    float secondDist = pNodes[second].intersect(pRay.iOrigin, pRay.iInvDirection, pMaxDist);
+                    if(secondDist < firstDist)
+                    {
+                        std::swap(first, second);
+                        std::swap(firstDist, secondDist);
+                    }
+
+                    if(firstDist < inf())
+                    {
+                        if(secondDist < inf())
+                        {
+                            stack[stackSize].iNode = second;
+                            stack[stackSize].iDist = secondDist;
+                            ++stackSize;
+                        }
+                        pos = first;
+                        continue;
+                    }
+                }
+
+                // next node on the stack that is still closer than the nearest hit
+                for(;;)
+                {
+                    if(stackSize == 0)
+                        return false;
+                    --stackSize;
+                    if(stack[stackSize].iDist < pMaxDist)
+                        break;
+                }
+                pos = stack[stackSize].iNode;
+            }
+        }
+
+        struct TriangleLeaf
+        {
+            const TriangleBox* iTriangles;
+            bool iStopAtFirstHit;
+
+            bool operator()(unsigned int pFirst, unsigned int pCount, const FlatRay& pRay, float& pMaxDist) const
+            {
+                for(unsigned int i = pFirst; i < pFirst + pCount; ++i)
+                {
+                    float t = intersectTriangle(pRay, iTriangles[i]);
+                    if(t < pMaxDist)
+                    {
+                        pMaxDist = t;
+                        if(iStopAtFirstHit)
+                            return true;
+                    }
+                }
+                return false;
+            }
+        };
+
+        struct SubModelLeaf
+        {
+            const FlatTreeNode* iNodes;
+            const SubModel* iSubModels;
+            const unsigned int* iRoots;
+            bool iStopAtFirstHit;
+
+            bool operator()(unsigned int pFirst, unsigned int pCount, const FlatRay& pRay, float& pMaxDist) const
+            {
+                for(unsigned int i = pFirst; i < pFirst + pCount; ++i)
+                {
+                    if(iRoots[i] == FLAT_TREE_NONE)
+                        continue;
+
+                    // triangles are relative to the SubModel
+                    const SubModel& sm = iSubModels[i];
+                    FlatRay relativeRay(pRay.iOrigin - sm.getBasePosition(), pRay.iDirection);
+                    TriangleLeaf leaf;
+                    leaf.iTriangles = sm.getTriangles();
+                    leaf.iStopAtFirstHit = iStopAtFirstHit;
+                    if(walkFlatTree(iNodes, iRoots[i], relativeRay, pMaxDist, leaf))
+                        return true;
+                }
+                return false;
+            }
+        };
+    }
+
+    //=================================================================
+
+    void ModelContainer::intersectFlatTree(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit) const
+    {
+        SubModelLeaf leaf;
+        leaf.iNodes = iFlatNodes;
+        leaf.iSubModels = iSubModel;
+        leaf.iRoots = iSubModelFlatRoots;
+        leaf.iStopAtFirstHit = pStopAtFirstHit;
+
+        FlatRay ray(pRay.origin, pRay.direction);
+        walkFlatTree(iFlatNodes, iFlatRoot, ray, pMaxDist, leaf);
+    }
+
+    //=================================================================
+
     void ModelContainer::intersect(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit, G3D::Vector3& /*pOutLocation*/, G3D::Vector3& /*pOutNormal*/) const
     {
+        if(iFlatNodes)
+        {
+            intersectFlatTree(pRay, pMaxDist, pStopAtFirstHit);
+            return;
+        }
+
         IntersectionCallBack<SubModel> intersectCallback;
         NodeValueAccess<TreeNode, SubModel> vna = NodeValueAccess<TreeNode, SubModel>(getTreeNodes(), iSubModel);
         Ray relativeRay = Ray::fromOriginAndDirection(pRay.origin - getBasePosition(), pRay.direction);
@@ -52,12 +52,21 @@ namespace VMAP
             SubModel *iSubModel;
             G3D::AABox iBox;
 
+            // flat copy of the trees for ray casts, built by readFile(), not part of the file
+            FlatTreeNode *iFlatNodes;
+            unsigned int iNFlatNodes;
+            unsigned int iFlatRoot;
+            unsigned int *iSubModelFlatRoots;
+
             // not allowed copy
             explicit ModelContainer (const ModelContainer&);
             ModelContainer& operator=(const ModelContainer&);
 
+            void freeFlatTree();
+            void intersectFlatTree(const G3D::Ray& pRay, float& pMaxDist, bool pStopAtFirstHit) const;
+
         public:
-            ModelContainer() : BaseModel() { iNSubModel =0; iSubModel = 0; };
+            ModelContainer() : BaseModel(), iFlatNodes(0), iNFlatNodes(0), iFlatRoot(FLAT_TREE_NONE), iSubModelFlatRoots(0) { iNSubModel =0; iSubModel = 0; };
 
             // for the mainnode
             ModelContainer(unsigned int pNTriangles, unsigned int pNNodes, unsigned int pNSubModel);
@@ -86,6 +95,12 @@ namespace VMAP
 
             bool readFile(const char *filename);
 
+            /**
+            Convert the TreeNodes of the container and all SubModels into one array of FlatTreeNodes.
+            Values are still read from the SubModel and TriangleBox arrays, only the traversal changes.
+            */
+            void buildFlatTree();
+
             size_t getMemUsage();
             size_t hashCode() { return (getBasePosition() * getNTriangles()).hashCode(); }
 
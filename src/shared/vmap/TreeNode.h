@@ -37,6 +37,55 @@ namespace VMAP
 
     //=====================================================
 
+    #define FLAT_TREE_INNER     0xFFFFFFFF                  // FlatTreeNode::iCount of inner nodes
+    #define FLAT_TREE_NONE      0xFFFFFFFF                  // no flat tree for a SubModel without nodes
+    #define FLAT_TREE_MAX_DEPTH 64                          // traversal stack size, deeper trees keep using the TreeNodes
+
+    /**
+    Node of the flat tree the ModelContainer builds out of the TreeNodes when it is loaded.
+    Only leaves hold values (SubModels or triangles), the first child of an inner node is stored right behind it
+    and the bounds are plain floats, so a node is 32 bytes and the tree is walked without recursion.
+    */
+    struct FlatTreeNode
+    {
+        float iLow[3];
+        unsigned int iOffset;                               // inner node: position of the second child, leaf: first value
+        float iHigh[3];
+        unsigned int iCount;                                // leaf: number of values, FLAT_TREE_INNER for inner nodes
+
+        inline bool isLeaf() const { return(iCount != FLAT_TREE_INNER); }
+
+        /**
+        Slab test with the inverse ray direction. Returns the entry distance (negative if the origin is inside)
+        or inf() if the box is missed or entered beyond pMaxDist.
+        */
+        inline float intersect(const G3D::Vector3& pOrigin, const G3D::Vector3& pInvDir, float pMaxDist) const
+        {
+            float t1 = (iLow[0] - pOrigin.x) * pInvDir.x;
+            float t2 = (iHigh[0] - pOrigin.x) * pInvDir.x;
+            float tmin = t1 < t2 ? t1 : t2;
+            float tmax = t1 < t2 ? t2 : t1;
+
+            t1 = (iLow[1] - pOrigin.y) * pInvDir.y;
+            t2 = (iHigh[1] - pOrigin.y) * pInvDir.y;
+            if(t1 > t2) { float t = t1; t1 = t2; t2 = t; }
+            if(t1 > tmin) tmin = t1;
+            if(t2 < tmax) tmax = t2;
+
+            t1 = (iLow[2] - pOrigin.z) * pInvDir.z;
+            t2 = (iHigh[2] - pOrigin.z) * pInvDir.z;
+            if(t1 > t2) { float t = t1; t1 = t2; t2 = t; }
+            if(t1 > tmin) tmin = t1;
+            if(t2 < tmax) tmax = t2;
+
+            if(tmax < 0.0f || tmin > tmax || tmin >= pMaxDist)
+                return(G3D::inf());
+            return(tmin);
+        }
+    };
+
+    //=====================================================
+
     class TreeNode
     {
     private:
@@ -19,14 +19,45 @@
 #include "VMapManager.h"
 #include "VMapDefinitions.h"
 
+#include <string.h>
+#include <ace/Atomic_Op.h>
+#include <ace/Guard_T.h>
+#include <ace/TSS_T.h>
+
 using namespace G3D;
 
 namespace VMAP
 {
+    //=========================================================
+    /**
+    Make data written by the loading thread visible before the pointer to it. The atomic increment is a full
+    barrier for the compiler and the cpu, readers only follow the pointer (dependent loads).
+    */
+    static ACE_Atomic_Op<ACE_Thread_Mutex, long> gPublishBarrier;
+
+    template<class T>
+    inline void publishPointer(T* volatile& pDest, T* pValue)
+    {
+        ++gPublishBarrier;
+        pDest = pValue;
+    }
 
     //=========================================================
+    // the line of sight cache of the current thread, the cache itself belongs to the VMapManager
+    struct LineOfSightCacheHolder
+    {
+        LineOfSightCacheHolder() : iOwner(NULL), iCache(NULL) {}
+
+        const VMapManager* iOwner;
+        LineOfSightCache* iCache;
+    };
 
-    VMapManager::VMapManager()
+    static ACE_TSS<LineOfSightCacheHolder> gLineOfSightCacheHolder;
+
+    //=========================================================
+
+    VMapManager::VMapManager() :
+        iInstanceMapTrees(new MapTreeTable()), iSnapshotGeneration(0), iLineOfSightCacheClock(0), iLineOfSightCacheTime(0)
     {
 #ifdef _VMAP_LOG_DEBUG
         iCommandLogger.setFileName("vmapcmd.log");
@@ -38,11 +69,84 @@ namespace VMAP
 
     VMapManager::~VMapManager(void)
     {
-        Array<unsigned int > keyArray = iInstanceMapTrees.getKeys();
+        Array<unsigned int > keyArray = iInstanceMapTrees->getKeys();
         for(int i=0;i<keyArray.size(); ++i)
+            delete iInstanceMapTrees->get(keyArray[i]);
+        delete iInstanceMapTrees;
+
+        iRetiredData.release();
+
+        for(int i=0;i<iLineOfSightCaches.size(); ++i)
+            delete iLineOfSightCaches[i];
+    }
+
+    //=========================================================
+
+    const MapTreeSnapshot* VMapManager::_getSnapshot(unsigned int pMapId) const
+    {
+        MapTree* mapTree;
+        if(!iInstanceMapTrees->get(pMapId, mapTree))
+            return NULL;
+        return mapTree->getSnapshot();
+    }
+
+    //=========================================================
+    /**
+    Add (pMapTree != NULL) or remove a MapTree. Readers may be using the current table, so a changed copy is published.
+    */
+    void VMapManager::_setMapTree(unsigned int pMapId, MapTree* pMapTree)
+    {
+        MapTreeTable* oldTable = iInstanceMapTrees;
+        MapTreeTable* newTable = new MapTreeTable(*oldTable);
+        if(pMapTree)
+            newTable->set(pMapId, pMapTree);
+        else
+        {
+            iRetiredData.retire(newTable->get(pMapId));
+            newTable->remove(pMapId);
+        }
+        publishPointer(iInstanceMapTrees, newTable);
+        iRetiredData.retire(oldTable);
+    }
+
+    //=========================================================
+
+    void VMapManager::update(unsigned int pDiff)
+    {
+        iLineOfSightCacheClock += pDiff;
+
+        ACE_GUARD(ACE_Thread_Mutex, guard, iWriteLock);
+        iRetiredData.release();
+    }
+
+    //=========================================================
+
+    LineOfSightCache& VMapManager::_getLineOfSightCache()
+    {
+        LineOfSightCacheHolder* holder = gLineOfSightCacheHolder;
+        if(holder->iOwner != this)
         {
-            delete iInstanceMapTrees.get(keyArray[i]);
-            iInstanceMapTrees.remove(keyArray[i]);
+            holder->iOwner = this;
+            holder->iCache = new LineOfSightCache();
+
+            ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iLineOfSightCachesLock, *holder->iCache);
+            iLineOfSightCaches.append(holder->iCache);
+        }
+        return *holder->iCache;
+    }
+
+    //=========================================================
+
+    void VMapManager::getLineOfSightCacheStats(unsigned long long& pHits, unsigned long long& pMisses)
+    {
+        pHits = 0;
+        pMisses = 0;
+
+        ACE_GUARD(ACE_Thread_Mutex, guard, iLineOfSightCachesLock);
+        for(int i=0;i<iLineOfSightCaches.size(); ++i)
+        {
+            pHits += iLineOfSightCaches[i]->iHits;
+            pMisses += iLineOfSightCaches[i]->iMisses;
         }
     }
 
@@ -176,6 +280,7 @@ namespace VMAP
 
     void VMapManager::preventMapsFromBeingUsed(const char* pMapIdString)
     {
+        ACE_GUARD(ACE_Thread_Mutex, guard, iWriteLock);
         if(pMapIdString != NULL)
         {
             unsigned int pos =0;
@@ -193,6 +298,7 @@ namespace VMAP
 
     int VMapManager::loadMap(const char* pBasePath, unsigned int pMapId, int x, int y)
     {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iWriteLock, VMAP_LOAD_RESULT_ERROR);
         int result = VMAP_LOAD_RESULT_IGNORED;
         if(isMapLoadingEnabled() && !iIgnoreMapIds.containsKey(pMapId))
         {
@@ -239,25 +345,26 @@ namespace VMAP
         {
             dirFileName = getDirFileName(pMapId);
         }
-        MapTree* instanceTree;
-        if(!iInstanceMapTrees.containsKey(pMapId))
+        MapTree* instanceTree = getInstanceMapTree(pMapId);
+        bool newTree = false;
+        if(!instanceTree)
         {
             instanceTree = new MapTree(pBasePath);
-            iInstanceMapTrees.set(pMapId, instanceTree);
+            newTree = true;
         }
-        else
-            instanceTree = iInstanceMapTrees.get(pMapId);
 
         unsigned int mapTileIdent = MAP_TILE_IDENT(x,y);
-        result = instanceTree->loadMap(dirFileName, mapTileIdent);
-        if(!result)                                         // remove on fail
+        result = instanceTree->loadMap(dirFileName, mapTileIdent, ++iSnapshotGeneration, iRetiredData);
+        if(newTree)
         {
+            // a new tree is not seen by readers yet, drop it without delay
             if(instanceTree->size() == 0)
-            {
-                iInstanceMapTrees.remove(pMapId);
                 delete instanceTree;
-            }
+            else
+                _setMapTree(pMapId, instanceTree);
         }
+        else if(!result && instanceTree->size() == 0)       // remove on fail
+            _setMapTree(pMapId, NULL);
         return(result);
     }
 
@@ -307,6 +414,7 @@ namespace VMAP
 
     bool VMapManager::existsMap(const char* pBasePath, unsigned int pMapId, int x, int y)
     {
+        ACE_GUARD_RETURN(ACE_Thread_Mutex, guard, iWriteLock, false);
         std::string basePath = std::string(pBasePath);
         if(basePath.length() > 0 && (basePath[basePath.length()-1] != '/' || basePath[basePath.length()-1] != '\\'))
         {
@@ -329,6 +437,7 @@ namespace VMAP
 
     void VMapManager::unloadMap(unsigned int pMapId, int x, int y)
     {
+        ACE_GUARD(ACE_Thread_Mutex, guard, iWriteLock);
         _unloadMap(pMapId, x, y);
 
 #ifdef _VMAP_LOG_DEBUG
@@ -342,9 +451,8 @@ namespace VMAP
 
     void VMapManager::_unloadMap(unsigned int  pMapId, int x, int y)
     {
-        if(iInstanceMapTrees.containsKey(pMapId))
+        if(MapTree* instanceTree = getInstanceMapTree(pMapId))
         {
-            MapTree* instanceTree = iInstanceMapTrees.get(pMapId);
             std::string dirFileName;
             if(iMapsSplitIntoTiles.containsKey(pMapId))
             {
@@ -355,12 +463,9 @@ namespace VMAP
                 dirFileName = getDirFileName(pMapId);
             }
             unsigned int mapTileIdent = MAP_TILE_IDENT(x,y);
-            instanceTree->unloadMap(dirFileName, mapTileIdent);
+            instanceTree->unloadMap(dirFileName, mapTileIdent, ++iSnapshotGeneration, iRetiredData);
             if(instanceTree->size() == 0)
-            {
-                iInstanceMapTrees.remove(pMapId);
-                delete instanceTree;
-            }
+                _setMapTree(pMapId, NULL);
         }
     }
 
@@ -368,16 +473,13 @@ namespace VMAP
 
     void VMapManager::unloadMap(unsigned int pMapId)
     {
-        if(iInstanceMapTrees.containsKey(pMapId))
+        ACE_GUARD(ACE_Thread_Mutex, guard, iWriteLock);
+        if(MapTree* instanceTree = getInstanceMapTree(pMapId))
         {
-            MapTree* instanceTree = iInstanceMapTrees.get(pMapId);
             std::string dirFileName = getDirFileName(pMapId);
-            instanceTree->unloadMap(dirFileName, 0, true);
+            instanceTree->unloadMap(dirFileName, 0, ++iSnapshotGeneration, iRetiredData, true);
             if(instanceTree->size() == 0)
-            {
-                iInstanceMapTrees.remove(pMapId);
-                delete instanceTree;
-            }
+                _setMapTree(pMapId, NULL);
 #ifdef _VMAP_LOG_DEBUG
             Command c = Command();
             c.fillUnloadTileCmd(pMapId);
@@ -387,17 +489,41 @@ namespace VMAP
     }
     //==========================================================
 
+    bool VMapManager::_isInLineOfSight(const MapTreeSnapshot* pSnapshot, const Vector3& pos1, const Vector3& pos2)
+    {
+        if(pos1 == pos2)
+            return true;
+
+        if(!iLineOfSightCacheTime)
+            return pSnapshot->isInLineOfSight(pos1, pos2);
+
+        LineOfSightCache& cache = _getLineOfSightCache();
+        unsigned int now = iLineOfSightCacheClock;
+        bool result;
+        if(cache.get(pSnapshot->getGeneration(), pos1, pos2, now, iLineOfSightCacheTime, result))
+        {
+            ++cache.iHits;
+            return result;
+        }
+
+        ++cache.iMisses;
+        result = pSnapshot->isInLineOfSight(pos1, pos2);
+        cache.set(pSnapshot->getGeneration(), pos1, pos2, now, result);
+        return result;
+    }
+
+    //=========================================================
+
     bool VMapManager::isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2)
     {
         bool result = true;
-        if(isLineOfSightCalcEnabled() && iInstanceMapTrees.containsKey(pMapId))
+        if(isLineOfSightCalcEnabled())
         {
-            Vector3 pos1 = convertPositionToInternalRep(x1,y1,z1);
-            Vector3 pos2 = convertPositionToInternalRep(x2,y2,z2);
-            if(pos1 != pos2)
+            if(const MapTreeSnapshot* snapshot = _getSnapshot(pMapId))
             {
-                MapTree* mapTree = iInstanceMapTrees.get(pMapId);
-                result = mapTree->isInLineOfSight(pos1, pos2);
+                Vector3 pos1 = convertPositionToInternalRep(x1,y1,z1);
+                Vector3 pos2 = convertPositionToInternalRep(x2,y2,z2);
+                result = _isInLineOfSight(snapshot, pos1, pos2);
 #ifdef _VMAP_LOG_DEBUG
                 Command c = Command();
                                                             // save the orig vectors
@@ -408,6 +534,33 @@ namespace VMAP
         }
         return(result);
     }
+
+    //=========================================================
+    /**
+    same as above for many targets, the map tree lookup and the origin conversion are done once
+    */
+    void VMapManager::isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, const float* pTargets, unsigned int pCount, bool* pResults)
+    {
+        const MapTreeSnapshot* snapshot = NULL;
+        if(isLineOfSightCalcEnabled())
+            snapshot = _getSnapshot(pMapId);
+
+        if(!snapshot)
+        {
+            for(unsigned int i = 0; i < pCount; ++i)
+                pResults[i] = true;
+            return;
+        }
+
+        Vector3 pos1 = convertPositionToInternalRep(x1,y1,z1);
+        for(unsigned int i = 0; i < pCount; ++i)
+        {
+            const float* target = pTargets + i*3;
+            Vector3 pos2 = convertPositionToInternalRep(target[0], target[1], target[2]);
+            pResults[i] = _isInLineOfSight(snapshot, pos1, pos2);
+        }
+    }
+
     //=========================================================
     /**
     get the hit position and return true if we hit something
@@ -421,13 +574,12 @@ namespace VMAP
         rz=z2;
         if(isLineOfSightCalcEnabled())
         {
-            if(iInstanceMapTrees.containsKey(pMapId))
+            if(const MapTreeSnapshot* snapshot = _getSnapshot(pMapId))
             {
                 Vector3 pos1 = convertPositionToInternalRep(x1,y1,z1);
                 Vector3 pos2 = convertPositionToInternalRep(x2,y2,z2);
                 Vector3 resultPos;
-                MapTree* mapTree = iInstanceMapTrees.get(pMapId);
-                result = mapTree->getObjectHitPos(pos1, pos2, resultPos, pModifyDist);
+                result = snapshot->getObjectHitPos(pos1, pos2, resultPos, pModifyDist);
                 resultPos = convertPositionToMangosRep(resultPos.x,resultPos.y,resultPos.z);
                 rx = resultPos.x;
                 ry = resultPos.y;
@@ -451,11 +603,11 @@ namespace VMAP
     float VMapManager::getHeight(unsigned int pMapId, float x, float y, float z)
     {
         float height = VMAP_INVALID_HEIGHT_VALUE;           //no height
-        if(isHeightCalcEnabled() && iInstanceMapTrees.containsKey(pMapId))
+        const MapTreeSnapshot* snapshot = isHeightCalcEnabled() ? _getSnapshot(pMapId) : NULL;
+        if(snapshot)
         {
             Vector3 pos = convertPositionToInternalRep(x,y,z);
-            MapTree* mapTree = iInstanceMapTrees.get(pMapId);
-            height = mapTree->getHeight(pos);
+            height = snapshot->getHeight(pos);
             if(!(height < inf()))
             {
                 height = VMAP_INVALID_HEIGHT_VALUE;         //no height
@@ -512,29 +664,96 @@ namespace VMAP
     //=========================================================
     //=========================================================
 
-    MapTree::MapTree(const char* pBaseDir)
+    unsigned int LineOfSightCache::makeKey(unsigned int pGeneration, const Vector3& pos1, const Vector3& pos2, int* pKey)
     {
-        iBasePath = std::string(pBaseDir);
-        if(iBasePath.length() > 0 && (iBasePath[iBasePath.length()-1] != '/' || iBasePath[iBasePath.length()-1] != '\\'))
-        {
-            iBasePath.append("/");
-        }
-        iTree = new AABSPTree<ModelContainer *>();
+        const float scale = 1.0f / LOS_CACHE_GRID;
+        pKey[0] = int(floor(pos1.x * scale));
+        pKey[1] = int(floor(pos1.y * scale));
+        pKey[2] = int(floor(pos1.z * scale));
+        pKey[3] = int(floor(pos2.x * scale));
+        pKey[4] = int(floor(pos2.y * scale));
+        pKey[5] = int(floor(pos2.z * scale));
+
+        unsigned int hash = pGeneration;
+        for(int i = 0; i < 6; ++i)
+            hash = hash * 0x01000193 ^ (unsigned int)pKey[i];
+        return (hash ^ (hash >> 16)) & (LOS_CACHE_SIZE - 1);
     }
 
     //=========================================================
-    MapTree::~MapTree()
+
+    bool LineOfSightCache::get(unsigned int pGeneration, const Vector3& pos1, const Vector3& pos2, unsigned int pNow, unsigned int pMaxAge, bool& pResult) const
     {
-        Array<ModelContainer *> mcArray;
-        iTree->getMembers(mcArray);
-        int no = mcArray.size();
-        while(no >0)
+        if(!iEntries)
+            return false;
+
+        int key[6];
+        const Entry& entry = iEntries[makeKey(pGeneration, pos1, pos2, key)];
+
+        // unsigned difference, stays right when the clock wraps around
+        // results of an older snapshot of the map are never used
+        if(!entry.iValid || entry.iGeneration != pGeneration || pNow - entry.iTime >= pMaxAge || memcmp(entry.iKey, key, sizeof(key)) != 0)
+            return false;
+
+        pResult = entry.iResult;
+        return true;
+    }
+
+    //=========================================================
+
+    void LineOfSightCache::set(unsigned int pGeneration, const Vector3& pos1, const Vector3& pos2, unsigned int pNow, bool pResult)
+    {
+        if(!iEntries)
         {
-            --no;
-            delete mcArray[no];
+            iEntries = new Entry[LOS_CACHE_SIZE];
+            memset(iEntries, 0, sizeof(Entry) * LOS_CACHE_SIZE);
         }
-        delete iTree;
+
+        int key[6];
+        Entry& entry = iEntries[makeKey(pGeneration, pos1, pos2, key)];
+        memcpy(entry.iKey, key, sizeof(key));
+        entry.iGeneration = pGeneration;
+        entry.iTime = pNow;
+        entry.iValid = true;
+        entry.iResult = pResult;
+    }
+
+    //=========================================================
+    //=========================================================
+    //=========================================================
+
+    void RetiredData::release()
+    {
+        for(int i=0;i<iMapTreeTables.size(); ++i)
+            delete iMapTreeTables[i];
+        iMapTreeTables.clear();
+
+        // MapTrees are retired empty, they only own their last snapshot
+        for(int i=0;i<iMapTrees.size(); ++i)
+            delete iMapTrees[i];
+        iMapTrees.clear();
+
+        for(int i=0;i<iSnapshots.size(); ++i)
+            delete iSnapshots[i];
+        iSnapshots.clear();
+
+        for(int i=0;i<iModelContainers.size(); ++i)
+            delete iModelContainers[i];
+        iModelContainers.clear();
     }
+
+    //=========================================================
+    //=========================================================
+    //=========================================================
+
+    MapTreeSnapshot::MapTreeSnapshot(const Array<ManagedModelContainer *>& pModelContainers, unsigned int pGeneration) :
+        iGeneration(pGeneration)
+    {
+        for(int i=0;i<pModelContainers.size(); ++i)
+            iTree.insert(pModelContainers[i]);
+        iTree.balance();
+    }
+
     //=========================================================
 
     // just for visual debugging with an external debug class
@@ -552,12 +771,12 @@ namespace VMAP
     return dist to hit or inf() if no hit
     */
 
-    float MapTree::getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit)
+    float MapTreeSnapshot::getIntersectionTime(const Ray& pRay, float pMaxDist, bool pStopAtFirstHit) const
     {
         float firstDistance = inf();
         IntersectionCallBack<ModelContainer> intersectionCallBack;
         float t = pMaxDist;
-        iTree->intersectRay(pRay, intersectionCallBack, t, pStopAtFirstHit, false);
+        iTree.intersectRay(pRay, intersectionCallBack, t, pStopAtFirstHit, false);
 #ifdef _DEBUG_VMAPS
         {
             if(t < pMaxDist)
@@ -575,7 +794,7 @@ namespace VMAP
     }
     //=========================================================
 
-    bool MapTree::isInLineOfSight(const Vector3& pos1, const Vector3& pos2)
+    bool MapTreeSnapshot::isInLineOfSight(const Vector3& pos1, const Vector3& pos2) const
     {
         bool result = true;
         float maxDist = abs((pos2 - pos1).magnitude());
@@ -594,7 +813,7 @@ namespace VMAP
     Return the hit pos or the original dest pos
     */
 
-    bool MapTree::getObjectHitPos(const Vector3& pPos1, const Vector3& pPos2, Vector3& pResultHitPos, float pModifyDist)
+    bool MapTreeSnapshot::getObjectHitPos(const Vector3& pPos1, const Vector3& pPos2, Vector3& pResultHitPos, float pModifyDist) const
     {
         bool result;
         float maxDist = abs((pPos2 - pPos1).magnitude());
@@ -631,7 +850,7 @@ namespace VMAP
 
     //=========================================================
 
-    float MapTree::getHeight(const Vector3& pPos)
+    float MapTreeSnapshot::getHeight(const Vector3& pPos) const
     {
         float height = inf();
         Vector3 dir = Vector3(0,-1,0);
@@ -645,15 +864,67 @@ namespace VMAP
         return(height);
     }
 
+    //=========================================================
+    //=========================================================
     //=========================================================
 
-    bool MapTree::PrepareTree()
+    MapTree::MapTree(const char* pBaseDir) : iSnapshot(NULL)
     {
-        iTree->balance();
-        return true;
+        iBasePath = std::string(pBaseDir);
+        if(iBasePath.length() > 0 && (iBasePath[iBasePath.length()-1] != '/' || iBasePath[iBasePath.length()-1] != '\\'))
+        {
+            iBasePath.append("/");
+        }
+    }
+
+    //=========================================================
+    MapTree::~MapTree()
+    {
+        iLoadedModelContainer.deleteValues();
+        delete iSnapshot;
+    }
+
+    //=========================================================
+
+    void MapTree::getLoadedModelContainers(Array<ManagedModelContainer *>& pArray) const
+    {
+        for(Table<std::string, ManagedModelContainer *>::Iterator i = iLoadedModelContainer.begin(); i != iLoadedModelContainer.end(); ++i)
+            pArray.append(i->value);
+    }
+
+    //=========================================================
+
+    void MapTree::getModelContainer(Array<ModelContainer *>& pArray)
+    {
+        for(Table<std::string, ManagedModelContainer *>::Iterator i = iLoadedModelContainer.begin(); i != iLoadedModelContainer.end(); ++i)
+            pArray.append(i->value);
+    }
+
+    //=========================================================
+    /**
+    Replace the snapshot queries use by one of the currently loaded ModelContainers.
+    The old one may still be in use, it is handed over to pRetired.
+    */
+    void MapTree::publishSnapshot(unsigned int pGeneration, RetiredData& pRetired)
+    {
+        MapTreeSnapshot* oldSnapshot = iSnapshot;
+        MapTreeSnapshot* newSnapshot = NULL;
+        // a tree without members can't be balanced
+        if(iLoadedModelContainer.size() > 0)
+        {
+            Array<ManagedModelContainer *> mcArray;
+            getLoadedModelContainers(mcArray);
+            newSnapshot = new MapTreeSnapshot(mcArray, pGeneration);
+        }
+
+        publishPointer(iSnapshot, newSnapshot);
+        if(oldSnapshot)
+            pRetired.retire(oldSnapshot);
     }
 
-    bool MapTree::loadMap(const std::string& pDirFileName, unsigned int pMapTileIdent)
+    //=========================================================
+
+    bool MapTree::loadMap(const std::string& pDirFileName, unsigned int pMapTileIdent, unsigned int pGeneration, RetiredData& pRetired)
     {
         bool result = true;
         if(!hasDirFile(pDirFileName))
@@ -681,11 +952,13 @@ namespace VMAP
                             fname.append(name);
                             mc = new ManagedModelContainer();
                             result = mc->readFile(fname.c_str());
-                            if(result)
+                            if(!result)
                             {
-                                addModelContainer(name, mc);
-                                newModelLoaded = true;
+                                delete mc;
+                                break;
                             }
+                            iLoadedModelContainer.set(name, mc);
+                            newModelLoaded = true;
                         }
                         else
                         {
@@ -694,9 +967,10 @@ namespace VMAP
                         mc->incRefCount();
                     }
                 }
-                if(result && newModelLoaded)
+                // models loaded before a failure stay, as they did before
+                if(newModelLoaded)
                 {
-                    iTree->balance();
+                    publishSnapshot(pGeneration, pRetired);
                 }
                 if(result && ferror(df) != 0)
                 {
@@ -726,7 +1000,7 @@ namespace VMAP
 
     //=========================================================
 
-    void MapTree::unloadMap(const std::string& dirFileName, unsigned int pMapTileIdent, bool pForce)
+    void MapTree::unloadMap(const std::string& dirFileName, unsigned int pMapTileIdent, unsigned int pGeneration, RetiredData& pRetired, bool pForce)
     {
         if(hasDirFile(dirFileName) && (pForce || containsLoadedMapTile(pMapTileIdent)))
         {
@@ -746,28 +1020,19 @@ namespace VMAP
                     if(mc->getRefCount() <= 0)
                     {
                         iLoadedModelContainer.remove(name);
-                        iTree->remove(mc);
-                        delete mc;
+                        pRetired.retire(mc);
                         treeChanged = true;
                     }
                 }
                 iLoadedDirFiles.remove(dirFileName);
                 if(treeChanged)
                 {
-                    iTree->balance();
+                    publishSnapshot(pGeneration, pRetired);
                 }
             }
         }
     }
 
-    //=========================================================
-    //=========================================================
-
-    void MapTree::addModelContainer(const std::string& pName, ManagedModelContainer *pMc)
-    {
-        iLoadedModelContainer.set(pName, pMc);
-        iTree->insert(pMc);
-    }
     //=========================================================
     //=========================================================
     //=========================================================
@@ -27,6 +27,7 @@
 #include "DebugCmdLogger.h"
 #endif
 #include <G3D/Table.h>
+#include <ace/Thread_Mutex.h>
 
 //===========================================================
 
@@ -40,10 +41,18 @@ For each map or map tile to load it reads a directory file that contains the Mod
 Each global map or instance has its own dynamic BSP-Tree.
 The loaded ModelContainers are included in one of these BSP-Trees.
 Additionally a table to match map ids and map names is used.
+
+Queries may run from several map threads at once without locking. Loading and unloading is serialized by a lock
+and never changes data a query can see: it builds a new MapTreeSnapshot (or table of MapTrees), publishes it with
+one pointer store and keeps the replaced data until update() is called while no map is updated.
 */
 
 // Create a value describing the map tile
 #define MAP_TILE_IDENT(x,y) ((x<<8) + y)
+
+// Line of sight cache: entries per thread (power of 2) and endpoint grid in yards
+#define LOS_CACHE_SIZE 4096
+#define LOS_CACHE_GRID 0.5f
 //===========================================================
 
 namespace VMAP
@@ -66,15 +75,101 @@ namespace VMAP
     };
 
     //===========================================================
+    /**
+    Short lived line of sight results of one thread.
+    Endpoints are quantized to LOS_CACHE_GRID, so creatures checking the same targets again and again
+    (aggro, spell casts, AI) only trace the ray once per cache time. Direct mapped, a colliding
+    query simply replaces the old entry. The generation of the MapTreeSnapshot is part of the key,
+    results for geometry that was loaded or unloaded since are never found.
+    */
+    class LineOfSightCache
+    {
+        private:
+            struct Entry
+            {
+                int iKey[6];
+                unsigned int iGeneration;
+                unsigned int iTime;
+                bool iValid;
+                bool iResult;
+            };
+
+            Entry* iEntries;
+
+            static unsigned int makeKey(unsigned int pGeneration, const G3D::Vector3& pos1, const G3D::Vector3& pos2, int* pKey);
+        public:
+            // only written by the owning thread, read by the stats command
+            unsigned long long iHits;
+            unsigned long long iMisses;
+
+            LineOfSightCache() : iEntries(NULL), iHits(0), iMisses(0) {}
+            ~LineOfSightCache() { delete[] iEntries; }
+
+            bool get(unsigned int pGeneration, const G3D::Vector3& pos1, const G3D::Vector3& pos2, unsigned int pNow, unsigned int pMaxAge, bool& pResult) const;
+            void set(unsigned int pGeneration, const G3D::Vector3& pos1, const G3D::Vector3& pos2, unsigned int pNow, bool pResult);
+    };
+
+    //===========================================================
+    /**
+    The ModelContainers of a map that were loaded at one point in time, in a balanced tree.
+    It is never changed after it was published, so any number of threads can query it.
+    */
+    class MapTreeSnapshot
+    {
+        private:
+            G3D::AABSPTree<ModelContainer *> iTree;
+            unsigned int iGeneration;
+
+            float getIntersectionTime(const G3D::Ray& pRay, float pMaxDist, bool pStopAtFirstHit) const;
+        public:
+            MapTreeSnapshot(const G3D::Array<ManagedModelContainer *>& pModelContainers, unsigned int pGeneration);
+
+            // unique for each snapshot ever published
+            unsigned int getGeneration() const { return iGeneration; }
+
+            bool isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2) const;
+            bool getObjectHitPos(const G3D::Vector3& pos1, const G3D::Vector3& pos2, G3D::Vector3& pResultHitPos, float pModifyDist) const;
+            float getHeight(const G3D::Vector3& pPos) const;
+    };
+
+    //===========================================================
+
+    class MapTree;
+    typedef G3D::Table<unsigned int , MapTree *> MapTreeTable;
+
+    /**
+    Data replaced by a load or unload. Queries that started before may still use it,
+    so it is only deleted by VMapManager::update().
+    */
+    class RetiredData
+    {
+        private:
+            G3D::Array<ManagedModelContainer *> iModelContainers;
+            G3D::Array<MapTreeSnapshot *> iSnapshots;
+            G3D::Array<MapTree *> iMapTrees;
+            G3D::Array<MapTreeTable *> iMapTreeTables;
+        public:
+            ~RetiredData() { release(); }
+
+            void retire(ManagedModelContainer* pMc) { iModelContainers.append(pMc); }
+            void retire(MapTreeSnapshot* pSnapshot) { iSnapshots.append(pSnapshot); }
+            void retire(MapTree* pMapTree) { iMapTrees.append(pMapTree); }
+            void retire(MapTreeTable* pTable) { iMapTreeTables.append(pTable); }
+
+            void release();
+    };
+
     //===========================================================
     //===========================================================
     //===========================================================
 
+    /**
+    Loading state of one map, only used by the thread holding the VMapManager write lock.
+    Queries only use the published snapshot.
+    */
     class MapTree
     {
         private:
-            G3D::AABSPTree<ModelContainer *> *iTree;
-
             // Key: filename, value ModelContainer
             G3D::Table<std::string, ManagedModelContainer *> iLoadedModelContainer;
 
@@ -86,13 +181,17 @@ namespace VMAP
             G3D::Table<unsigned int, bool> iLoadedMapTiles;
             std::string iBasePath;
 
+            // NULL while no model is loaded
+            MapTreeSnapshot* volatile iSnapshot;
+
         private:
-            float getIntersectionTime(const G3D::Ray& pRay, float pMaxDist, bool pStopAtFirstHit);
             bool isAlreadyLoaded(const std::string& pName) const { return(iLoadedModelContainer.containsKey(pName)); }
             void setLoadedMapTile(unsigned int pTileIdent) { iLoadedMapTiles.set(pTileIdent, true); }
             void removeLoadedMapTile(unsigned int pTileIdent) { iLoadedMapTiles.remove(pTileIdent); }
             bool hasLoadedMapTiles() const { return iLoadedMapTiles.size() > 0; }
             bool containsLoadedMapTile(unsigned int pTileIdent) const { return(iLoadedMapTiles.containsKey(pTileIdent)); }
+            void getLoadedModelContainers(G3D::Array<ManagedModelContainer *>& pArray) const;
+            void publishSnapshot(unsigned int pGeneration, RetiredData& pRetired);
         public:
             ManagedModelContainer *getModelContainer(const std::string& pName) { return(iLoadedModelContainer.get(pName)); }
             bool hasDirFile(const std::string& pDirName) const { return(iLoadedDirFiles.containsKey(pDirName)); }
@@ -101,18 +200,14 @@ namespace VMAP
             MapTree(const char *pBasePath);
             ~MapTree();
 
-            bool isInLineOfSight(const G3D::Vector3& pos1, const G3D::Vector3& pos2);
-            bool getObjectHitPos(const G3D::Vector3& pos1, const G3D::Vector3& pos2, G3D::Vector3& pResultHitPos, float pModifyDist);
-            float getHeight(const G3D::Vector3& pPos);
+            const MapTreeSnapshot* getSnapshot() const { return iSnapshot; }
 
-            bool PrepareTree();
-            bool loadMap(const std::string& pDirFileName, unsigned int pMapTileIdent);
-            void addModelContainer(const std::string& pName, ManagedModelContainer *pMc);
-            void unloadMap(const std::string& dirFileName, unsigned int pMapTileIdent, bool pForce=false);
+            bool loadMap(const std::string& pDirFileName, unsigned int pMapTileIdent, unsigned int pGeneration, RetiredData& pRetired);
+            void unloadMap(const std::string& dirFileName, unsigned int pMapTileIdent, unsigned int pGeneration, RetiredData& pRetired, bool pForce=false);
 
-            void getModelContainer(G3D::Array<ModelContainer *>& pArray ) { iTree->getMembers(pArray); }
+            void getModelContainer(G3D::Array<ModelContainer *>& pArray );
             void addDirFile(const std::string& pDirName, const FilesInDir& pFilesInDir) { iLoadedDirFiles.set(pDirName, pFilesInDir); }
-            size_t size() { return(iTree->size()); }
+            size_t size() { return(iLoadedModelContainer.size()); }
     };
 
     //===========================================================
@@ -127,11 +222,24 @@ namespace VMAP
     class VMapManager : public IVMapManager
     {
         private:
-            // Tree to check collision
-            G3D::Table<unsigned int , MapTree *> iInstanceMapTrees;
+            // Tree to check collision, replaced as a whole when a map is added or removed
+            MapTreeTable* volatile iInstanceMapTrees;
             G3D::Table<unsigned int , bool> iMapsSplitIntoTiles;
             G3D::Table<unsigned int , bool> iIgnoreMapIds;
 
+            // serializes loading and unloading, queries never take it
+            ACE_Thread_Mutex iWriteLock;
+            RetiredData iRetiredData;
+            unsigned int iSnapshotGeneration;
+
+            // milliseconds, advanced by update()
+            unsigned int volatile iLineOfSightCacheClock;
+            unsigned int iLineOfSightCacheTime;
+
+            // caches of all threads that ever checked line of sight, freed with the manager
+            G3D::Array<LineOfSightCache *> iLineOfSightCaches;
+            ACE_Thread_Mutex iLineOfSightCachesLock;
+
 #ifdef _VMAP_LOG_DEBUG
             CommandFileRW iCommandLogger;
 #endif
@@ -139,6 +247,10 @@ namespace VMAP
             bool _loadMap(const char* pBasePath, unsigned int pMapId, int x, int y, bool pForceTileLoad=false);
             void _unloadMap(unsigned int  pMapId, int x, int y);
             bool _existsMap(const std::string& pBasePath, unsigned int pMapId, int x, int y, bool pForceTileLoad);
+            bool _isInLineOfSight(const MapTreeSnapshot* pSnapshot, const G3D::Vector3& pos1, const G3D::Vector3& pos2);
+            const MapTreeSnapshot* _getSnapshot(unsigned int pMapId) const;
+            void _setMapTree(unsigned int pMapId, MapTree* pMapTree);
+            LineOfSightCache& _getLineOfSightCache();
 
         public:
             // public for debug
@@ -146,7 +258,7 @@ namespace VMAP
             G3D::Vector3 convertPositionToMangosRep(float x, float y, float z) const;
             std::string getDirFileName(unsigned int pMapId) const;
             std::string getDirFileName(unsigned int pMapId, int x, int y) const;
-            MapTree* getInstanceMapTree(int pMapId) { return(iInstanceMapTrees.get(pMapId)); }
+            MapTree* getInstanceMapTree(int pMapId) { MapTree* mapTree = NULL; iInstanceMapTrees->get(pMapId, mapTree); return mapTree; }
         public:
             VMapManager();
             ~VMapManager(void);
@@ -159,6 +271,11 @@ namespace VMAP
             void unloadMap(unsigned int pMapId);
 
             bool isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, float x2, float y2, float z2) ;
+            void isInLineOfSight(unsigned int pMapId, float x1, float y1, float z1, const float* pTargets, unsigned int pCount, bool* pResults);
+
+            void setLineOfSightCacheTime(unsigned int pTime) { iLineOfSightCacheTime = pTime; }
+            void update(unsigned int pDiff);
+            void getLineOfSightCacheStats(unsigned long long& pHits, unsigned long long& pMisses);
             /**
             fill the hit pos and return true, if an object was hit
             */